@@ -0,0 +1,84 @@
+#!/usr/bin/env python3
+#
+# Accuracy versus speed of the electromagnetic physics constructors
+# (laueDet -p): runs the same scenario with each of them and reports the
+# events/s of the event loop next to the photopeak efficiency and the
+# Compton modulation computed by laueObservables from the columnar
+# output, to choose the cheapest constructor whose observables agree
+# with the reference (livermorePolarized, the only one simulating the
+# polarisation of the photons).
+#
+# usage: em_physics.py --laueDet path/to/laueDet [options]
+# (the "physics_benchmark" target of the build runs it with the CMake settings)
+
+import argparse
+import json
+import os
+import subprocess
+
+from run_benchmarks import SCENARIOS, run_scenario
+
+PHYSICS = ["livermorePolarized", "livermore", "penelope", "standard", "standard_opt4"]
+
+
+def observables(args):
+    """laueObservables on the columnar files of a run directory."""
+    def analyse(workdir):
+        shards = sorted(name for name in os.listdir(workdir)
+                        if name.startswith("events") and name.endswith(".lcol"))
+        output = subprocess.run(
+            [args.observables, "-e", str(args.energy), "-w", str(args.window),
+             "-l", "lookup_table.bin"] + shards,
+            cwd=workdir, check=True, stdout=subprocess.PIPE, text=True).stdout
+        return json.loads(output)
+    return analyse
+
+
+def main():
+    parser = argparse.ArgumentParser(description="laueDet EM physics benchmark")
+    parser.add_argument("--laueDet", required=True, help="laueDet executable")
+    parser.add_argument("--observables",
+                        help="laueObservables executable (default: next to laueDet)")
+    parser.add_argument("--threads", type=int, default=os.cpu_count(),
+                        help="number of threads")
+    parser.add_argument("--events", type=int, default=100000,
+                        help="number of events per run")
+    parser.add_argument("--scenario", default="on_axis", choices=SCENARIOS)
+    parser.add_argument("--physics", nargs="+", default=PHYSICS, choices=PHYSICS)
+    parser.add_argument("--energy", type=float, default=200.,
+                        help="beam energy of the scenario in keV")
+    parser.add_argument("--window", type=float, default=2.,
+                        help="half width of the photopeak window in keV")
+    parser.add_argument("--output", default="em_physics.json", help="JSON report")
+    parser.add_argument("extra", nargs="*",
+                        help="other laueDet options after --, e.g. -- -r tasking")
+    args = parser.parse_args()
+    if not args.observables:
+        args.observables = os.path.join(os.path.dirname(os.path.abspath(args.laueDet)),
+                                        "laueObservables")
+    args.format = "lcol"
+
+    report = {"scenario": args.scenario, "events": args.events,
+              "threads": args.threads, "physics": {}}
+    print("{:20s} {:>12s} {:>8s} {:>12s} {:>18s}".format(
+          "physics", "events/s", "rel.cost", "photopeak", "modulation"))
+    extra = args.extra
+    for physics in args.physics:
+        args.extra = ["-p", physics] + extra
+        result = run_scenario(args, args.scenario, args.threads, observables(args))
+        del result["spectra"]
+        report["physics"][physics] = result
+        reference = next(iter(report["physics"].values()))
+        print("{:20s} {:12.1f} {:8.2f} {:12.4f} {:10.4f} +- {:.4f}".format(
+              physics, result["events_per_s"],
+              reference["events_per_s"]/result["events_per_s"],
+              result["photopeak_efficiency"], result["modulation"],
+              result["modulation_error"]), flush=True)
+
+    with open(args.output, "w") as output:
+        json.dump(report, output, indent=2)
+    print("report written in " + args.output)
+
+
+if __name__ == "__main__":
+    main()
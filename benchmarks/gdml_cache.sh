@@ -0,0 +1,36 @@
+#!/bin/bash
+#
+# Geometry construction time without cache, when the GDML cache is
+# written (first job) and when the geometry is read from it (next jobs).
+#
+# usage: gdml_cache.sh [path/to/laueDet] [pixels per side]
+# Run it from the build directory (laueDet needs detector.mac).
+
+LAUEDET=${1:-./laueDet}
+PIXELS=${2:-10}
+
+WORKDIR=$(mktemp -d)
+trap "rm -rf $WORKDIR" EXIT
+
+run() {
+  cat > $WORKDIR/startup.mac <<EOM
+/detector/nPixelsA $PIXELS
+/detector/pitchA $(echo "100/$PIXELS" | bc -l) cm
+/detector/nPixelsB $PIXELS
+/detector/pitchB $(echo "100/$PIXELS" | bc -l) cm
+/detector/checkOverlaps off
+${1:+/detector/gdmlCache $1}
+/run/initialize
+EOM
+  local start=$(date +%s.%N)
+  $LAUEDET -m $WORKDIR/startup.mac -t 1 > $WORKDIR/startup.log 2>&1
+  local end=$(date +%s.%N)
+  local geometry=$(grep -E "Geometry (constructed|loaded from the GDML cache) in" \
+                   $WORKDIR/startup.log | grep -o "[0-9.e+-]* s" | head -1)
+  printf "%-22s geometry: %-12s job: %.2f s\n" "$2" "$geometry" \
+         $(echo "$end - $start" | bc -l)
+}
+
+run "" "no cache"
+run $WORKDIR/cache "cache written"
+run $WORKDIR/cache "cache read"
@@ -0,0 +1,50 @@
+#!/bin/bash
+#
+# Validation of the local deposit of the short range electrons
+# (/stacking/localDeposit): the same run (same seeds) is made with the
+# approximation off and on, the job times are printed and the spectra
+# are compared with compareSpectra.
+#
+# usage: local_deposit.sh [path/to/laueDet] [events] [maxRange in um]
+# (detector.mac and compareSpectra are taken next to laueDet)
+
+LAUEDET=$(realpath ${1:-./laueDet})
+EVENTS=${2:-100000}
+RANGE=${3:-1000}
+COMPARE=$(dirname $LAUEDET)/compareSpectra
+
+WORKDIR=$(mktemp -d)
+trap "rm -rf $WORKDIR" EXIT
+cp $(dirname $LAUEDET)/detector.mac $WORKDIR
+
+run() {
+  cat > $WORKDIR/$1.mac <<EOM
+/random/setSeeds 12345 67890
+/log/printInterval 1000000000
+/output/hits false
+/output/spectra true
+/run/initialize
+/stacking/localDeposit $2
+/stacking/maxRange $RANGE um
+/gps/particle gamma
+/gps/energy 200 keV
+/gps/polarization 1. 0. 0.
+/gps/pos/type Plane
+/gps/pos/shape Square
+/gps/pos/halfx 50.0 cm
+/gps/pos/halfy 50.0 cm
+/gps/direction 0. 0. 1.
+/gps/pos/centre 0. 0. -300. cm
+/run/beamOn $EVENTS
+EOM
+  local start=$(date +%s.%N)
+  (cd $WORKDIR && $LAUEDET -m $1.mac -t 1 > $1.log 2>&1) || {
+    echo "laueDet failed, see $WORKDIR/$1.log"; trap - EXIT; exit 1; }
+  local end=$(date +%s.%N)
+  mv $WORKDIR/spectra.lspc $WORKDIR/$1.lspc
+  printf "%-16s job: %.2f s\n" "$1" $(echo "$end - $start" | bc -l)
+}
+
+run tracked false
+run local_deposit true
+$COMPARE $WORKDIR/tracked.lspc $WORKDIR/local_deposit.lspc
@@ -0,0 +1,38 @@
+#!/bin/bash
+#
+# Physics tables and job startup times without cache, when the tables
+# cache is written (first job) and when the tables are read from it
+# (next jobs).
+#
+# usage: physics_tables.sh [path/to/laueDet] [emPhysics]
+# Run it from the build directory (laueDet needs detector.mac).
+
+LAUEDET=${1:-./laueDet}
+PHYSICS=${2:-livermorePolarized}
+
+WORKDIR=$(mktemp -d)
+trap "rm -rf $WORKDIR" EXIT
+
+run() {
+  cat > $WORKDIR/startup.mac <<EOM
+/detector/checkOverlaps off
+${1:+/physics/tableCache $1}
+/run/initialize
+/gps/particle gamma
+/gps/energy 200 keV
+/run/beamOn 1
+EOM
+  local start=$(date +%s.%N)
+  $LAUEDET -m $WORKDIR/startup.mac -t 1 -p $PHYSICS > $WORKDIR/startup.log 2>&1
+  local end=$(date +%s.%N)
+  local tables=$(grep -o "Physics tables [a-z]* in [0-9.e+-]* s" $WORKDIR/startup.log \
+                 | grep -o "[0-9.e+-]* s" | head -1)
+  local startup=$(grep -o "job startup [0-9.e+-]* s" $WORKDIR/startup.log \
+                  | grep -o "[0-9.e+-]* s" | head -1)
+  printf "%-22s tables: %-12s startup: %-12s job: %.2f s\n" "$2" "$tables" \
+         "$startup" $(echo "$end - $start" | bc -l)
+}
+
+run "" "no cache"
+run $WORKDIR/cache "cache written"
+run $WORKDIR/cache "cache read"
@@ -0,0 +1,46 @@
+#!/bin/bash
+#
+# Construction time, memory and navigation cost of the detectors A and B
+# as a function of the number of pixels per side (at constant size).
+#
+# usage: pixel_scaling.sh [path/to/laueDet] [nEvents] [pixel counts...]
+# Run it from the build directory (laueDet needs detector.mac).
+
+LAUEDET=${1:-./laueDet}
+NEVENTS=${2:-1000}
+shift 2
+PIXELS=${@:-10 32 64 128 256}
+
+WORKDIR=$(mktemp -d)
+trap "rm -rf $WORKDIR" EXIT
+
+printf "%8s %10s %14s %12s %12s\n" "pixels" "channels" "construct(s)" "maxRSS(MB)" "events/s"
+for n in $PIXELS; do
+  macro=$WORKDIR/pixels_$n.mac
+  cat > $macro <<EOM
+/detector/nPixelsA $n
+/detector/pitchA $(echo "100/$n" | bc -l) cm
+/detector/nPixelsB $n
+/detector/pitchB $(echo "100/$n" | bc -l) cm
+/run/verbose 1
+/run/initialize
+/output/hits false
+/gps/particle gamma
+/gps/energy 200 keV
+/gps/direction 0 0 1
+/gps/pos/type Plane
+/gps/pos/shape Square
+/gps/pos/centre 0 0 -300 cm
+/gps/pos/halfx 50 cm
+/gps/pos/halfy 50 cm
+/run/beamOn $NEVENTS
+EOM
+  log=$WORKDIR/pixels_$n.log
+  /usr/bin/time -v $LAUEDET -m $macro -t 1 > $log 2>&1
+
+  construct=$(grep "Geometry constructed in" $log | head -1 | awk '{print $5}')
+  rss=$(grep "Maximum resident set size" $log | awk '{printf "%.1f", $6/1024}')
+  real=$(grep -o "Real=[0-9.e+-]*s" $log | tail -1 | tr -d 'Real=s')
+  rate=$(echo "$NEVENTS/$real" | bc -l 2>/dev/null)
+  printf "%8d %10d %14s %12s %12.1f\n" $n $((2*n*n)) "$construct" "$rss" "${rate:-0}"
+done
@@ -0,0 +1,209 @@
+#!/usr/bin/env python3
+#
+# Throughput benchmark of laueDet: runs the scenarios of
+# benchmarks/scenarios in batch mode at 1..N threads and reports, for each
+# of them, the events/s (event loop only), the parallel efficiency, the
+# peak RSS, the output bytes/event and a summary of the detectors spectra
+# (hits per primaries sample and mean energy of each detector, to see the
+# effect of the production cuts) in a JSON file. With --baseline,
+# the event rates are compared with a previous report and the script
+# fails if one of them dropped by more than the tolerance.
+#
+# usage: run_benchmarks.py --laueDet path/to/laueDet [options]
+# (the "benchmarks" target of the build runs it with the CMake settings)
+
+import argparse
+import datetime
+import json
+import os
+import platform
+import re
+import shutil
+import struct
+import subprocess
+import sys
+import tempfile
+
+SCENARIOS_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), "scenarios")
+SCENARIOS = ["on_axis", "off_axis", "thick", "thin", "high_multiplicity", "focal_plane",
+             "coarse_cuts", "fine_cuts", "local_deposit", "multi_source"]
+
+# Run summary of the master (the workers lines start with G4WT)
+REAL_TIME = re.compile(r"^\s*User=\S+\s+Real=([0-9.eE+-]+)s")
+
+
+def thread_counts(max_threads):
+    counts = [1]
+    while counts[-1]*2 <= max_threads:
+        counts.append(counts[-1]*2)
+    if counts[-1] != max_threads:
+        counts.append(max_threads)
+    return counts
+
+
+def read_spectra(file_name):
+    """Hits per primaries sample (per event without the acceptance
+    resampling) and mean energy (keV) of the detectors A, B and C (first
+    digit of the detector ID) from a spectra file (SpectrumFile.hh)."""
+    with open(file_name, "rb") as spectra:
+        magic, channels, bins, width, _, e_min, e_max, events = \
+            struct.unpack("<8sIIIIddQ", spectra.read(48))
+        if magic == b"LAUESPC2":
+            samples, = struct.unpack("<Q", spectra.read(8))
+        elif magic == b"LAUESPC1":
+            samples = events
+        else:
+            sys.exit(file_name + " is not a spectra file")
+        ids = struct.unpack("<{}i".format(channels), spectra.read(4*channels))
+        counts = struct.unpack("<{}{}".format(channels*bins, "I" if width == 4 else "Q"),
+                               spectra.read(width*channels*bins))
+    bin_width = (e_max - e_min)/bins
+    summary = {}
+    for channel, detector_id in enumerate(ids):
+        detector = "ABC"[int(str(detector_id)[0]) - 1]
+        total, energy = summary.get(detector, (0, 0.))
+        for i, count in enumerate(counts[channel*bins:(channel + 1)*bins]):
+            total += count
+            energy += count*(e_min + (i + 0.5)*bin_width)
+        summary[detector] = (total, energy)
+    samples = samples or events
+    return {detector: {"hits_per_sample": total/max(samples, 1),
+                       "mean_energy_kev": energy/total if total else 0.}
+            for detector, (total, energy) in sorted(summary.items())}
+
+
+def run_scenario(args, scenario, threads, analyse=None):
+    """Run one scenario in a scratch directory, return its measurements
+    (with those of analyse(run directory) if given)."""
+    workdir = tempfile.mkdtemp(prefix="laue_bench_")
+    try:
+        laue_dir = os.path.dirname(os.path.abspath(args.laueDet))
+        shutil.copy(os.path.join(laue_dir, "detector.mac"), workdir)
+        shutil.copy(os.path.join(laue_dir, "focal_plane.tbl"), workdir)
+        shutil.copy(os.path.join(SCENARIOS_DIR, "beam.mac"), workdir)
+        shutil.copy(os.path.join(SCENARIOS_DIR, scenario + ".mac"), workdir)
+        with open(os.path.join(workdir, "bench.mac"), "w") as macro:
+            macro.write("/control/alias nEvents {}\n".format(args.events))
+            macro.write("/run/verbose 1\n")
+            macro.write("/log/printInterval 1000000000\n")
+            macro.write("/output/format {}\n".format(args.format))
+            macro.write("/output/spectra true\n")
+            macro.write("/control/execute {}.mac\n".format(scenario))
+
+        command = [os.path.abspath(args.laueDet), "-m", "bench.mac", "-t", str(threads)]
+        command += args.extra
+        with open(os.path.join(workdir, "laueDet.log"), "w") as log:
+            process = subprocess.Popen(command, cwd=workdir, stdout=log,
+                                       stderr=subprocess.STDOUT)
+            # wait4 gives the resources of this child only
+            _, status, usage = os.wait4(process.pid, 0)
+        process.returncode = os.waitstatus_to_exitcode(status)
+
+        real = None
+        with open(os.path.join(workdir, "laueDet.log")) as log:
+            for line in log:
+                match = REAL_TIME.match(line)
+                if match:
+                    real = float(match.group(1))
+        if process.returncode != 0 or not real:
+            sys.exit("{} with {} threads failed, see the log:\n{}".format(
+                     scenario, threads, os.path.join(workdir, "laueDet.log")))
+
+        output_bytes = sum(os.path.getsize(os.path.join(workdir, name))
+                           for name in os.listdir(workdir)
+                           if name.startswith("events"))
+        result = {
+            "real_s": real,
+            "events_per_s": args.events/real,
+            "peak_rss_mb": usage.ru_maxrss/1024.,   # kB on Linux
+            "bytes_per_event": output_bytes/args.events,
+            "spectra": read_spectra(os.path.join(workdir, "spectra.lspc")),
+        }
+        if analyse:
+            result.update(analyse(workdir))
+        shutil.rmtree(workdir)
+        return result
+    except BaseException:
+        print("run directory kept: " + workdir, file=sys.stderr)
+        raise
+
+
+def compare(report, baseline, tolerance):
+    """Print the event rates ratios; return False if one dropped."""
+    accepted = True
+    print("\n{:20s} {:>8s} {:>12s} {:>12s} {:>8s}".format(
+          "scenario", "threads", "baseline", "current", "ratio"))
+    for scenario, results in report["scenarios"].items():
+        for threads, result in results.items():
+            reference = baseline.get("scenarios", {}).get(scenario, {}).get(threads)
+            if not reference:
+                continue
+            ratio = result["events_per_s"]/reference["events_per_s"]
+            flag = ""
+            if ratio < 1. - tolerance:
+                flag = "  REGRESSION"
+                accepted = False
+            print("{:20s} {:>8s} {:12.1f} {:12.1f} {:8.3f}{}".format(
+                  scenario, threads, reference["events_per_s"],
+                  result["events_per_s"], ratio, flag))
+    return accepted
+
+
+def main():
+    parser = argparse.ArgumentParser(description="laueDet throughput benchmark")
+    parser.add_argument("--laueDet", required=True, help="laueDet executable")
+    parser.add_argument("--threads", type=int, default=os.cpu_count(),
+                        help="maximum number of threads (runs at 1, 2, 4 ... N)")
+    parser.add_argument("--events", type=int, default=10000,
+                        help="number of events per run")
+    parser.add_argument("--scenarios", nargs="+", default=SCENARIOS,
+                        choices=SCENARIOS)
+    parser.add_argument("--format", default="root", choices=["root", "csv", "lcol"],
+                        help="output format")
+    parser.add_argument("--output", default="benchmark.json", help="JSON report")
+    parser.add_argument("--baseline", help="JSON report to compare with")
+    parser.add_argument("--tolerance", type=float, default=0.05,
+                        help="accepted relative drop of the event rates")
+    parser.add_argument("extra", nargs="*",
+                        help="laueDet options after --, e.g. -- -r tasking -a numa")
+    args = parser.parse_args()
+
+    report = {
+        "host": platform.node(),
+        "date": datetime.datetime.now().isoformat(timespec="seconds"),
+        "events": args.events,
+        "format": args.format,
+        "options": args.extra,
+        "scenarios": {},
+    }
+    print("{:20s} {:>8s} {:>12s} {:>10s} {:>10s} {:>12s}".format(
+          "scenario", "threads", "events/s", "eff.", "RSS(MB)", "bytes/event"))
+    for scenario in args.scenarios:
+        results = {}
+        for threads in thread_counts(args.threads):
+            result = run_scenario(args, scenario, threads)
+            result["efficiency"] = (result["events_per_s"]
+                                    / (threads*results["1"]["events_per_s"])
+                                    if results else 1.)
+            results[str(threads)] = result
+            print("{:20s} {:8d} {:12.1f} {:10.2f} {:10.1f} {:12.1f}".format(
+                  scenario, threads, result["events_per_s"], result["efficiency"],
+                  result["peak_rss_mb"], result["bytes_per_event"]), flush=True)
+        report["scenarios"][scenario] = results
+        print("{:20s} {:>8s} {}".format("", "spectra", "  ".join(
+              "{}: {:.3f} hits/sample {:.1f} keV".format(
+                  detector, values["hits_per_sample"], values["mean_energy_kev"])
+              for detector, values in results["1"]["spectra"].items())), flush=True)
+
+    with open(args.output, "w") as output:
+        json.dump(report, output, indent=2)
+    print("report written in " + args.output)
+
+    if args.baseline:
+        with open(args.baseline) as baseline:
+            if not compare(report, json.load(baseline), args.tolerance):
+                sys.exit("event rate below the baseline")
+
+
+if __name__ == "__main__":
+    main()
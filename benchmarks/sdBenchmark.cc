@@ -0,0 +1,310 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+// $Id$
+//
+/// \file sdBenchmark.cc
+/// \brief Micro-benchmarks of the sensitive detector and output hot paths
+///
+/// The EmCalorimeterSD is driven with synthetic steps (pre-built G4Steps
+/// with their touchables, in a minimal geometry), without run manager and
+/// physics, for several pixel counts and numbers of energy deposits per
+/// event:
+///  - SD/volume, SD/virtual: Initialize, ProcessHits and EndOfEvent with
+///    the volume and the virtual (grid) readouts; the time per step of
+///    ProcessHits and the time per event of Initialize and EndOfEvent;
+///  - Output/<format>: EventAction::EndOfEventAction, i.e. the hits
+///    collection to ntuple row (root, csv) or columnar rows (lcol) path.
+///
+/// usage: sdBenchmark [-p "pixels per side..."] [-m "steps per event..."]
+///                    [-s steps per configuration] [-f root|csv|lcol]
+/// The output files are written in a temporary directory and removed.
+
+#include "EmCalorimeterSD.hh"
+#include "EventAction.hh"
+#include "RunAction.hh"
+
+#include "G4Box.hh"
+#include "G4DynamicParticle.hh"
+#include "G4Event.hh"
+#include "G4Gamma.hh"
+#include "G4HCofThisEvent.hh"
+#include "G4LogicalVolume.hh"
+#include "G4NavigationHistory.hh"
+#include "G4NistManager.hh"
+#include "G4PVPlacement.hh"
+#include "G4Run.hh"
+#include "G4SDManager.hh"
+#include "G4Step.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4TouchableHistory.hh"
+#include "G4Track.hh"
+#include "G4UImanager.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <vector>
+
+using namespace ED;
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+G4double Elapsed(Clock::time_point start, Clock::time_point stop)
+{
+  return std::chrono::duration<G4double, std::nano>(stop - start).count();
+}
+
+std::vector<G4int> ParseList(const char* list)
+{
+  std::vector<G4int> values;
+  std::istringstream input(list);
+  G4int value;
+  while ( input >> value ) values.push_back(value);
+  return values;
+}
+
+// A detector of nofPixels x nofPixels pixels of 1 mm, and a pool of
+// steps distributed uniformly over its pixels
+
+class SyntheticDetector
+{
+  public:
+    SyntheticDetector(G4int nofPixels, G4bool virtualReadout);
+
+    G4Step* GetStep(std::size_t i) const { return fSteps[i % fSteps.size()].get(); }
+    ChannelRange GetChannels() const { return { 1000, fNofPixels*fNofPixels, 0 }; }
+
+  private:
+    static constexpr std::size_t kNofSteps = 4096;
+
+    G4int fNofPixels;
+    std::unique_ptr<G4Track> fTrack;
+    std::vector<std::unique_ptr<G4Step>> fSteps;
+};
+
+SyntheticDetector::SyntheticDetector(G4int nofPixels, G4bool virtualReadout)
+ : fNofPixels(nofPixels)
+{
+  auto material = G4NistManager::Instance()->FindOrBuildMaterial("G4_Si");
+  auto pitch = 1.*mm;
+  auto halfSize = 0.5*nofPixels*pitch;
+  auto thickness = 0.5*cm;
+
+  auto worldLV = new G4LogicalVolume(
+    new G4Box("World", 2.*m, 2.*m, 4.*m), material, "World");
+  auto worldPV = new G4PVPlacement(nullptr, G4ThreeVector(), worldLV, "World",
+                                   nullptr, false, 0);
+  auto detectorLV = new G4LogicalVolume(
+    new G4Box("detector", halfSize, halfSize, thickness), material, "detector");
+  auto detectorPV = new G4PVPlacement(nullptr, G4ThreeVector(0., 0., -20.*cm),
+                                      detectorLV, "detector", worldLV, false, 0);
+  auto pixelLV = new G4LogicalVolume(
+    new G4Box("pixel", 0.5*pitch, 0.5*pitch, thickness), material, "pixel");
+  auto pixelPV = new G4PVPlacement(nullptr, G4ThreeVector(), pixelLV, "pixel",
+                                   detectorLV, false, 0);
+
+  // The steps are made by a photon (the deposit is at the post-step point
+  // with the virtual readout)
+  fTrack = std::make_unique<G4Track>(
+    new G4DynamicParticle(G4Gamma::Definition(), G4ThreeVector(0., 0., 1.), 200.*keV),
+    0., G4ThreeVector());
+
+  std::mt19937 random(12345);
+  std::uniform_int_distribution<G4int> pixel(0, nofPixels*nofPixels - 1);
+  std::uniform_real_distribution<G4double> edep(1.*keV, 100.*keV);
+  std::uniform_real_distribution<G4double> offset(-0.5*pitch, 0.5*pitch);
+
+  G4NavigationHistory history;
+  history.SetFirstEntry(worldPV);
+  history.NewLevel(detectorPV, kNormal, 0);
+  for ( std::size_t i=0; i<kNofSteps; ++i ) {
+    auto copyNo = pixel(random);
+    G4ThreeVector position(-halfSize + (copyNo/nofPixels + 0.5)*pitch + offset(random),
+                           -halfSize + (copyNo%nofPixels + 0.5)*pitch + offset(random),
+                           -20.*cm);
+
+    // Volume readout: the touchable of the pixel with its copy number;
+    // virtual readout: the touchable of the detector
+    G4TouchableHistory* touchable;
+    if ( virtualReadout ) {
+      touchable = new G4TouchableHistory(history);
+    }
+    else {
+      history.NewLevel(pixelPV, kNormal, copyNo);
+      touchable = new G4TouchableHistory(history);
+      history.BackLevel();
+    }
+
+    auto step = std::make_unique<G4Step>();
+    step->SetTrack(fTrack.get());
+    step->SetTotalEnergyDeposit(edep(random));
+    step->GetPreStepPoint()->SetTouchableHandle(G4TouchableHandle(touchable));
+    step->GetPreStepPoint()->SetPosition(position - G4ThreeVector(0., 0., 1.*mm));
+    step->GetPostStepPoint()->SetPosition(position);
+    fSteps.push_back(std::move(step));
+  }
+}
+
+// Time per step and per event of the SD with nofSteps steps per event
+
+void BenchmarkSD(G4int nofPixels, G4int nofStepsPerEvent, G4int nofSteps,
+                 G4bool virtualReadout)
+{
+  SyntheticDetector detector(nofPixels, virtualReadout);
+  std::ostringstream name;
+  name << ( virtualReadout ? "virtual" : "volume" ) << nofPixels << "_" << nofStepsPerEvent;
+  auto sd = new EmCalorimeterSD(name.str(), detector.GetChannels());
+  if ( virtualReadout ) sd->SetGridReadout(nofPixels, 1.*mm);
+  G4SDManager::GetSDMpointer()->AddNewDetector(sd);
+
+  G4double initTime = 0.;
+  G4double stepsTime = 0.;
+  G4double endTime = 0.;
+  auto nofEvents = std::max(nofSteps/nofStepsPerEvent, 100);
+  std::size_t iStep = 0;
+  for ( G4int event=0; event<nofEvents; ++event ) {
+    auto hce = G4SDManager::GetSDMpointer()->PrepareNewEvent();
+    auto start = Clock::now();
+    sd->Initialize(hce);
+    auto startSteps = Clock::now();
+    for ( G4int i=0; i<nofStepsPerEvent; ++i ) {
+      sd->ProcessHits(detector.GetStep(iStep++), nullptr);
+    }
+    auto startEnd = Clock::now();
+    sd->EndOfEvent(hce);
+    auto stop = Clock::now();
+    initTime += Elapsed(start, startSteps);
+    stepsTime += Elapsed(startSteps, startEnd);
+    endTime += Elapsed(startEnd, stop);
+    delete hce;
+  }
+
+  std::printf("%-16s %8d %8d %12.1f %14.1f %14.1f\n",
+              virtualReadout ? "SD/virtual" : "SD/volume", nofPixels,
+              nofStepsPerEvent, stepsTime/(G4double(nofEvents)*nofStepsPerEvent),
+              initTime/nofEvents, endTime/nofEvents);
+}
+
+// Time per event of the output of the hits by the EventAction
+
+void BenchmarkOutput(G4int nofPixels, G4int nofStepsPerEvent, G4int nofSteps,
+                     const G4String& format, EventAction* eventAction,
+                     RunAction* runAction)
+{
+  SyntheticDetector detector(nofPixels, false);
+  std::ostringstream name;
+  name << "output" << nofPixels << "_" << nofStepsPerEvent;
+  auto sd = new EmCalorimeterSD(name.str(), detector.GetChannels());
+  G4SDManager::GetSDMpointer()->AddNewDetector(sd);
+
+  G4Run run;
+  runAction->BeginOfRunAction(&run);
+
+  G4double outputTime = 0.;
+  auto nofEvents = std::max(nofSteps/nofStepsPerEvent, 100);
+  std::size_t iStep = 0;
+  for ( G4int i=0; i<nofEvents; ++i ) {
+    // The event owns the hits collections
+    G4Event event(i);
+    auto hce = G4SDManager::GetSDMpointer()->PrepareNewEvent();
+    event.SetHCofThisEvent(hce);
+    sd->Initialize(hce);
+    for ( G4int j=0; j<nofStepsPerEvent; ++j ) {
+      sd->ProcessHits(detector.GetStep(iStep++), nullptr);
+    }
+    sd->EndOfEvent(hce);
+
+    auto start = Clock::now();
+    eventAction->EndOfEventAction(&event);
+    outputTime += Elapsed(start, Clock::now());
+  }
+  runAction->EndOfRunAction(&run);
+
+  std::printf("%-16s %8d %8d %12s %14s %14.1f\n", ("Output/" + format).c_str(),
+              nofPixels, nofStepsPerEvent, "-", "-", outputTime/nofEvents);
+}
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+int main(int argc, char** argv)
+{
+  auto pixelCounts = ParseList("10 64 256");
+  auto multiplicities = ParseList("1 10 100");
+  G4int nofSteps = 1000000;
+  G4String format = "root";
+  for ( G4int i=1; i+1<argc; i+=2 ) {
+    G4String option = argv[i];
+    if      ( option == "-p" ) pixelCounts = ParseList(argv[i+1]);
+    else if ( option == "-m" ) multiplicities = ParseList(argv[i+1]);
+    else if ( option == "-s" ) nofSteps = std::atoi(argv[i+1]);
+    else if ( option == "-f" ) format = argv[i+1];
+    else {
+      std::fprintf(stderr, "usage: sdBenchmark [-p \"pixels per side...\"] "
+        "[-m \"steps per event...\"] [-s steps] [-f root|csv|lcol]\n");
+      return 1;
+    }
+  }
+
+  // The output files are not kept
+  auto workDir = std::filesystem::temp_directory_path() / "laue_sdBenchmark";
+  std::filesystem::create_directories(workDir);
+  std::filesystem::current_path(workDir);
+
+  // The output (RunAction books the ntuple of the EventAction)
+  auto eventAction = new EventAction();
+  auto runAction = new RunAction(eventAction);
+  G4UImanager::GetUIpointer()->ApplyCommand("/output/format " + format);
+
+  std::printf("%-16s %8s %8s %12s %14s %14s\n", "benchmark", "pixels",
+              "steps", "ns/step", "init ns/event", "end ns/event");
+  for ( auto virtualReadout : { false, true } ) {
+    for ( auto nofPixels : pixelCounts ) {
+      for ( auto multiplicity : multiplicities ) {
+        BenchmarkSD(nofPixels, multiplicity, nofSteps, virtualReadout);
+      }
+    }
+  }
+  for ( auto nofPixels : pixelCounts ) {
+    for ( auto multiplicity : multiplicities ) {
+      BenchmarkOutput(nofPixels, multiplicity, nofSteps, format,
+                      eventAction, runAction);
+    }
+  }
+
+  delete runAction;
+  delete eventAction;
+  std::filesystem::remove_all(workDir);
+}
@@ -0,0 +1,45 @@
+#!/bin/bash
+#
+# Startup wall time and peak RSS of a short batch job: headless (the
+# batch mode), with the visualization initialised (-v, as every batch job
+# did before) and, if given, with a batch only build of laueDet
+# (cmake -DWITH_GEANT4_UIVIS=OFF).
+#
+# usage: startup.sh [path/to/laueDet] [path/to/batch/only/laueDet] [jobs]
+# Run it from the build directory (laueDet needs detector.mac).
+
+LAUEDET=${1:-./laueDet}
+LEAN=$2
+JOBS=${3:-5}
+
+WORKDIR=$(mktemp -d)
+trap "rm -rf $WORKDIR" EXIT
+
+cat > $WORKDIR/startup.mac <<EOM
+/detector/checkOverlaps off
+/run/initialize
+/gps/particle gamma
+/gps/energy 200 keV
+/run/beamOn 1
+EOM
+
+# Mean wall time and peak RSS over the jobs
+run() {
+  local total=0
+  local rss=0
+  for job in $(seq $JOBS); do
+    /usr/bin/time -v "${@:2}" -m $WORKDIR/startup.mac -t 1 > $WORKDIR/startup.log 2>&1
+    local wall=$(grep "Elapsed (wall clock)" $WORKDIR/startup.log \
+                 | awk -F': ' '{print $2}' | awk -F: '{print $(NF-1)*60 + $NF}')
+    total=$(echo "$total + $wall" | bc -l)
+    rss=$(grep "Maximum resident set size" $WORKDIR/startup.log | awk '{print $6}')
+  done
+  printf "%-22s wall: %8.2f s   maxRSS: %8.1f MB\n" "$1" \
+         $(echo "$total/$JOBS" | bc -l) $(echo "$rss/1024" | bc -l)
+}
+
+run "batch (headless)" $LAUEDET
+run "batch with vis (-v)" $LAUEDET -v
+if [ -n "$LEAN" ]; then
+  run "batch only build" $LEAN
+fi
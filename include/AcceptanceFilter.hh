@@ -0,0 +1,82 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+// $Id$
+//
+/// \file AcceptanceFilter.hh
+/// \brief Definition of the AcceptanceFilter class
+
+#ifndef AcceptanceFilter_h
+#define AcceptanceFilter_h 1
+
+#include "G4AffineTransform.hh"
+#include "G4ThreeVector.hh"
+#include "globals.hh"
+
+#include <vector>
+
+class G4Event;
+class G4VSolid;
+
+namespace ED
+{
+
+/// Geometric acceptance of the primaries.
+///
+/// The envelopes are the daughters of the world volume which contain a
+/// sensitive detector (the detectors A, B and C). A primary is accepted
+/// if its straight line path (there is no field and the world is vacuum)
+/// starts in or enters one of them (a particle on the surface of an
+/// envelope is accepted only if it goes in), which is tested analytically with
+/// the DistanceToIn of their solids; the other primaries leave the world
+/// without any hit. The envelopes are found at the first test, once the
+/// sensitive detectors of the thread are set.
+
+class AcceptanceFilter
+{
+  public:
+    AcceptanceFilter() = default;
+
+    G4bool IsAccepted(const G4ThreeVector& position,
+                      const G4ThreeVector& direction);
+    // True if one of the primaries of the event is accepted
+    G4bool IsAccepted(const G4Event* event);
+
+  private:
+    struct Envelope
+    {
+      const G4VSolid* solid;
+      G4AffineTransform toLocal;
+    };
+
+    void FindEnvelopes();
+
+    std::vector<Envelope> fEnvelopes;
+    G4bool fInitialized = false;
+};
+
+}
+
+#endif
@@ -0,0 +1,111 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+// $Id$
+//
+/// \file AliasTable.hh
+/// \brief Definition of the AliasTable class
+
+#ifndef AliasTable_h
+#define AliasTable_h 1
+
+#include "globals.hh"
+
+#include <cstddef>
+#include <vector>
+
+namespace ED
+{
+
+/// Walker alias table of a discrete distribution (Vose's construction):
+/// an index is sampled in constant time with one uniform number,
+/// whatever the number of bins. The table is built once and is then
+/// read only, so that it can be shared by the worker threads.
+
+class AliasTable
+{
+  public:
+    AliasTable() = default;
+    explicit AliasTable(const std::vector<G4double>& weights);
+
+    // u uniform in [0, 1)
+    std::size_t Sample(G4double u) const
+    {
+      auto x = u*fProbabilities.size();
+      auto i = (std::size_t)x;
+      if ( i >= fProbabilities.size() ) i = fProbabilities.size() - 1;
+      return ( x - i < fProbabilities[i] ) ? i : fAliases[i];
+    }
+
+    std::size_t GetSize() const { return fProbabilities.size(); }
+    G4double GetTotalWeight() const { return fTotalWeight; }
+
+  private:
+    std::vector<G4double> fProbabilities;
+    std::vector<std::size_t> fAliases;
+    G4double fTotalWeight = 0.;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+inline AliasTable::AliasTable(const std::vector<G4double>& weights)
+ : fProbabilities(weights.size(), 1.),
+   fAliases(weights.size())
+{
+  for ( auto weight : weights ) fTotalWeight += weight;
+  if ( fTotalWeight <= 0. ) return;
+
+  // Bins below and above the mean weight
+  auto n = weights.size();
+  std::vector<G4double> scaled(n);
+  std::vector<std::size_t> small, large;
+  for ( std::size_t i=0; i<n; ++i ) {
+    fAliases[i] = i;
+    scaled[i] = weights[i]*n/fTotalWeight;
+    if ( scaled[i] < 1. ) small.push_back(i);
+    else                  large.push_back(i);
+  }
+
+  // Each small bin is completed by a large one
+  while ( ! small.empty() && ! large.empty() ) {
+    auto s = small.back();
+    small.pop_back();
+    auto l = large.back();
+    fProbabilities[s] = scaled[s];
+    fAliases[s] = l;
+    scaled[l] -= 1. - scaled[s];
+    if ( scaled[l] < 1. ) {
+      large.pop_back();
+      small.push_back(l);
+    }
+  }
+  // The bins left are full (up to rounding errors)
+  for ( auto i : small ) fProbabilities[i] = 1.;
+  for ( auto i : large ) fProbabilities[i] = 1.;
+}
+
+}
+
+#endif
@@ -0,0 +1,55 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+// $Id$
+//
+/// \file ChannelRange.hh
+/// \brief Definition of the ChannelRange structure
+
+#ifndef ChannelRange_h
+#define ChannelRange_h 1
+
+#include "globals.hh"
+
+namespace ED
+{
+
+/// Range of detector numbers owned by a sensitive detector:
+/// the channels first, first+1, ..., first+count-1, read out from the
+/// volumes with the copy numbers firstCopyNo, ..., firstCopyNo+count-1.
+
+struct ChannelRange
+{
+  G4int first = 0;
+  G4int count = 0;
+  G4int firstCopyNo = 0;
+
+  G4bool Contains(G4int channel) const
+  { return channel >= first && channel < first + count; }
+};
+
+}
+
+#endif
@@ -0,0 +1,97 @@
+/// \file ColumnarFormat.hh
+/// \brief Layout of the laueDet columnar binary output format (.lcol)
+///
+/// The file is made of:
+///  - a FileHeader, followed by one ColumnDescriptor per column;
+///  - the data chunks: for each chunk, one block per column with the
+///    chunk rows stored contiguously (fixed width values), each block
+///    padded to a multiple of 8 bytes;
+///  - the metadata block: "key=value" lines (schema independent run
+///    metadata), padded to a multiple of 8 bytes;
+///  - the chunk index: one ChunkIndexEntry per chunk.
+/// The header is rewritten when the file is closed with the offsets of
+/// the metadata block and of the chunk index.
+/// Column 0 is the event ID; the chunk index records its minimum and
+/// maximum in each chunk (the rows need not be sorted).
+/// All values are stored in the native (little-endian) byte order.
+///
+/// This header does not depend on Geant4 so that it can be used by the
+/// analysis programs (see ColumnarReader.hh).
+
+#ifndef ColumnarFormat_h
+#define ColumnarFormat_h 1
+
+#include <cstdint>
+#include <cstring>
+
+namespace ED
+{
+namespace lcol
+{
+
+constexpr char     kMagic[8] = { 'L', 'A', 'U', 'E', 'C', 'O', 'L', '1' };
+constexpr uint32_t kVersion = 1;
+constexpr uint32_t kNameSize = 24;
+
+enum class ColumnType : uint32_t
+{
+  kInt32   = 1,
+  kInt64   = 2,
+  kFloat32 = 3,
+  kFloat64 = 4
+};
+
+inline uint32_t TypeWidth(ColumnType type)
+{
+  return ( type == ColumnType::kInt32 || type == ColumnType::kFloat32 ) ? 4 : 8;
+}
+
+inline uint64_t Padded(uint64_t size)
+{
+  return (size + 7) & ~uint64_t(7);
+}
+
+struct FileHeader
+{
+  char     magic[8];
+  uint32_t version;
+  uint32_t nofColumns;
+  uint64_t nofRows;
+  uint64_t nofChunks;
+  uint64_t metadataOffset;
+  uint64_t metadataSize;
+  uint64_t indexOffset;    // 0 if the file was not closed properly
+};
+
+struct ColumnDescriptor
+{
+  char       name[kNameSize];  // null terminated
+  ColumnType type;
+  uint32_t   width;
+};
+
+struct ChunkIndexEntry
+{
+  uint64_t offset;         // of the first column block
+  uint64_t nofRows;
+  int64_t  minEventID;     // range of the event IDs of the chunk rows
+  int64_t  maxEventID;
+};
+
+static_assert(sizeof(FileHeader) == 56, "unexpected FileHeader layout");
+static_assert(sizeof(ColumnDescriptor) == 32, "unexpected ColumnDescriptor layout");
+static_assert(sizeof(ChunkIndexEntry) == 32, "unexpected ChunkIndexEntry layout");
+
+inline ColumnDescriptor MakeColumn(const char* name, ColumnType type)
+{
+  ColumnDescriptor column {};
+  std::strncpy(column.name, name, kNameSize - 1);
+  column.type = type;
+  column.width = TypeWidth(type);
+  return column;
+}
+
+}
+}
+
+#endif
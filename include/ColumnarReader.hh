@@ -0,0 +1,216 @@
+/// \file ColumnarReader.hh
+/// \brief Header-only zero-copy reader of the laueDet columnar format
+///
+/// The file is memory mapped and the column blocks of each chunk are
+/// exposed as spans pointing in the mapping, without any copy:
+///
+///   ED::lcol::Reader reader("events_t0.lcol");
+///   auto energy = reader.FindColumn("Energy");
+///   for ( std::size_t i=0; i<reader.GetNofChunks(); ++i ) {
+///     for ( auto e : reader.GetColumn<double>(i, energy) ) { ... }
+///   }
+///
+/// It depends only on the C++17 standard library and POSIX mmap,
+/// errors are reported with std::runtime_error.
+
+#ifndef ColumnarReader_h
+#define ColumnarReader_h 1
+
+#include "ColumnarFormat.hh"
+
+#include <cstddef>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ED
+{
+namespace lcol
+{
+
+/// Read-only view of a contiguous array
+
+template <typename T>
+class Span
+{
+  public:
+    Span() = default;
+    Span(const T* data, std::size_t size) : fData(data), fSize(size) {}
+
+    const T* data() const { return fData; }
+    std::size_t size() const { return fSize; }
+    bool empty() const { return fSize == 0; }
+    const T* begin() const { return fData; }
+    const T* end() const { return fData + fSize; }
+    const T& operator[](std::size_t i) const { return fData[i]; }
+
+  private:
+    const T* fData = nullptr;
+    std::size_t fSize = 0;
+};
+
+template <typename T> constexpr ColumnType TypeOf();
+template <> constexpr ColumnType TypeOf<int32_t>() { return ColumnType::kInt32; }
+template <> constexpr ColumnType TypeOf<int64_t>() { return ColumnType::kInt64; }
+template <> constexpr ColumnType TypeOf<float>()   { return ColumnType::kFloat32; }
+template <> constexpr ColumnType TypeOf<double>()  { return ColumnType::kFloat64; }
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+class Reader
+{
+  public:
+    explicit Reader(const std::string& fileName);
+    ~Reader();
+
+    Reader(const Reader&) = delete;
+    Reader& operator=(const Reader&) = delete;
+
+    const FileHeader& GetHeader() const { return *fHeader; }
+    uint64_t GetNofRows() const { return fHeader->nofRows; }
+    std::size_t GetNofChunks() const { return fHeader->nofChunks; }
+    std::size_t GetNofColumns() const { return fHeader->nofColumns; }
+
+    const ColumnDescriptor& GetColumnDescriptor(std::size_t column) const
+    { return fColumns[column]; }
+    // Returns the column index, throws if not found
+    std::size_t FindColumn(const std::string& name) const;
+
+    const ChunkIndexEntry& GetChunk(std::size_t chunk) const
+    { return fIndex[chunk]; }
+    const std::map<std::string, std::string>& GetMetadata() const
+    { return fMetadata; }
+
+    // Values of a column in a chunk, as stored in the file
+    template <typename T>
+    Span<T> GetColumn(std::size_t chunk, std::size_t column) const;
+    // Raw address of a column block
+    const void* GetColumnData(std::size_t chunk, std::size_t column) const;
+
+  private:
+    const char* fData = nullptr;
+    std::size_t fSize = 0;
+    const FileHeader* fHeader = nullptr;
+    const ColumnDescriptor* fColumns = nullptr;
+    const ChunkIndexEntry* fIndex = nullptr;
+    std::map<std::string, std::string> fMetadata;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+inline Reader::Reader(const std::string& fileName)
+{
+  auto fd = ::open(fileName.c_str(), O_RDONLY);
+  if ( fd < 0 ) {
+    throw std::runtime_error("lcol: cannot open " + fileName);
+  }
+  struct stat status;
+  if ( ::fstat(fd, &status) != 0 || status.st_size < (off_t)sizeof(FileHeader) ) {
+    ::close(fd);
+    throw std::runtime_error("lcol: " + fileName + " is not a columnar file");
+  }
+  fSize = status.st_size;
+  auto address = ::mmap(nullptr, fSize, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if ( address == MAP_FAILED ) {
+    throw std::runtime_error("lcol: cannot map " + fileName);
+  }
+  fData = static_cast<const char*>(address);
+  ::madvise(address, fSize, MADV_SEQUENTIAL);
+
+  fHeader = reinterpret_cast<const FileHeader*>(fData);
+  auto columnsEnd = sizeof(FileHeader) + fHeader->nofColumns*sizeof(ColumnDescriptor);
+  std::string error;
+  if ( std::memcmp(fHeader->magic, kMagic, sizeof(kMagic)) != 0 ) {
+    error = "is not a columnar file";
+  }
+  else if ( fHeader->version != kVersion ) {
+    error = "has an unsupported version";
+  }
+  else if ( fHeader->indexOffset == 0 ) {
+    error = "was not closed properly";
+  }
+  else if ( columnsEnd > fSize ||
+            fHeader->metadataOffset + fHeader->metadataSize > fSize ||
+            fHeader->indexOffset + fHeader->nofChunks*sizeof(ChunkIndexEntry) > fSize ) {
+    error = "is truncated";
+  }
+  if ( ! error.empty() ) {
+    ::munmap(address, fSize);
+    throw std::runtime_error("lcol: " + fileName + " " + error);
+  }
+
+  fColumns = reinterpret_cast<const ColumnDescriptor*>(fData + sizeof(FileHeader));
+  fIndex = reinterpret_cast<const ChunkIndexEntry*>(fData + fHeader->indexOffset);
+
+  // Metadata: key=value lines
+  std::string metadata(fData + fHeader->metadataOffset, fHeader->metadataSize);
+  std::size_t begin = 0;
+  while ( begin < metadata.size() ) {
+    auto end = metadata.find('\n', begin);
+    if ( end == std::string::npos ) end = metadata.size();
+    auto line = metadata.substr(begin, end - begin);
+    auto equal = line.find('=');
+    if ( equal != std::string::npos ) {
+      fMetadata[line.substr(0, equal)] = line.substr(equal + 1);
+    }
+    begin = end + 1;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+inline Reader::~Reader()
+{
+  if ( fData ) ::munmap(const_cast<char*>(fData), fSize);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+inline std::size_t Reader::FindColumn(const std::string& name) const
+{
+  for ( std::size_t i=0; i<fHeader->nofColumns; ++i ) {
+    if ( name == fColumns[i].name ) return i;
+  }
+  throw std::runtime_error("lcol: no column " + name);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+inline const void* Reader::GetColumnData(std::size_t chunk, std::size_t column) const
+{
+  // The column blocks of a chunk follow each other, padded to 8 bytes
+  const auto& entry = fIndex[chunk];
+  auto offset = entry.offset;
+  for ( std::size_t i=0; i<column; ++i ) {
+    offset += Padded(entry.nofRows*fColumns[i].width);
+  }
+  if ( offset + entry.nofRows*fColumns[column].width > fSize ) {
+    throw std::runtime_error("lcol: chunk out of the file");
+  }
+  return fData + offset;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+template <typename T>
+inline Span<T> Reader::GetColumn(std::size_t chunk, std::size_t column) const
+{
+  if ( fColumns[column].type != TypeOf<T>() ) {
+    throw std::runtime_error(
+      std::string("lcol: wrong type for column ") + fColumns[column].name);
+  }
+  return Span<T>(static_cast<const T*>(GetColumnData(chunk, column)),
+                 fIndex[chunk].nofRows);
+}
+
+}
+}
+
+#endif
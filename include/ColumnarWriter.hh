@@ -0,0 +1,88 @@
+/// \file ColumnarWriter.hh
+/// \brief Definition of the ColumnarWriter class
+
+#ifndef ColumnarWriter_h
+#define ColumnarWriter_h 1
+
+#include "ColumnarFormat.hh"
+
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ED
+{
+
+/// Writer of the columnar binary format described in ColumnarFormat.hh.
+///
+/// The rows are buffered column by column and written in chunks of
+/// fixed number of rows. The values of a row are set with Fill()
+/// (one call per column, in any order) and the row is committed with
+/// AddRow(). The file is finalised by Close() or by the destructor.
+/// It does not depend on Geant4 (it is also used by laueMerge).
+
+class ColumnarWriter
+{
+  public:
+    ColumnarWriter(const std::string& fileName,
+                   const std::vector<lcol::ColumnDescriptor>& columns,
+                   std::size_t chunkSize = 65536);
+    ~ColumnarWriter();
+
+    ColumnarWriter(const ColumnarWriter&) = delete;
+    ColumnarWriter& operator=(const ColumnarWriter&) = delete;
+
+    bool IsOpen() const { return fFile != nullptr; }
+    const std::string& GetFileName() const { return fFileName; }
+    uint64_t GetNofRows() const { return fNofRows; }
+
+    void SetMetadata(const std::string& key, const std::string& value);
+
+    template <typename T>
+    void Fill(std::size_t column, T value);
+    void AddRow();
+
+    // Append one row given as one pointer per column value
+    void AddRow(const std::vector<const void*>& values);
+
+    bool Close();
+
+  private:
+    void FlushChunk();
+    void Write(const void* data, std::size_t size);
+
+    std::string fFileName;
+    std::FILE* fFile = nullptr;
+    std::vector<lcol::ColumnDescriptor> fColumns;
+    std::size_t fChunkSize;
+
+    // Buffers of the current chunk, one per column
+    std::vector<std::vector<char>> fBuffers;
+    std::vector<char> fRow;             // values of the row being filled
+    std::vector<std::size_t> fRowOffsets;
+    std::size_t fNofBufferedRows = 0;
+    int64_t fMinEventID = 0;
+    int64_t fMaxEventID = 0;
+
+    std::vector<lcol::ChunkIndexEntry> fIndex;
+    std::vector<std::pair<std::string, std::string>> fMetadata;
+    uint64_t fOffset = 0;
+    uint64_t fNofRows = 0;
+    bool fGood = true;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+template <typename T>
+inline void ColumnarWriter::Fill(std::size_t column, T value)
+{
+  assert(column < fColumns.size() && sizeof(T) == fColumns[column].width);
+  std::memcpy(&fRow[fRowOffsets[column]], &value, sizeof(T));
+}
+
+}
+
+#endif
@@ -32,6 +32,10 @@
 #define DetectorConstruction_h 1
 
 #include "G4VUserDetectorConstruction.hh"
+#include "ChannelRange.hh"
+#include "GeometryIndex.hh"
+
+#include <vector>
 
 class G4VPhysicalVolume;
 class G4GenericMessenger;
@@ -51,9 +55,55 @@ class DetectorConstruction : public G4VUserDetectorConstruction
     G4VPhysicalVolume* Construct() override;
     void ConstructSDandField() override;
 
+    // Channels of the detectors A, B and C units: the channel numbers
+    // start from 1000, 2000, 3000 (or multiples of a larger power of 10
+    // for large pixel arrays). The pixels of A and B are parameterised,
+    // their copy numbers start from 0.
+    G4int GetChannelStride() const;
+    ChannelRange GetChannelsA() const
+    { return {1*GetChannelStride(), fNofPixelsA*fNofPixelsA, 0}; }
+    ChannelRange GetChannelsB() const
+    { return {2*GetChannelStride(), fNofPixelsB*fNofPixelsB, 0}; }
+    ChannelRange GetChannelsC() const
+    { return {3*GetChannelStride(), fNofSegmentsC, 3*GetChannelStride()}; }
+    std::vector<ChannelRange> GetChannelRanges() const
+    { return { GetChannelsA(), GetChannelsB(), GetChannelsC() }; }
+
+    // Hash of the geometry parameters
+    G4String GetGeometryHash() const;
+
+    // Global centre and rotation of each channel
+    const GeometryIndex& GetGeometryIndex() const { return fGeometryIndex; }
+
   private:
+    void BuildGeometryIndex(G4VPhysicalVolume* worldPV);
+    void CheckOverlaps(G4VPhysicalVolume* worldPV) const;
+    void ConstructRegion();
+    void SetDetectorCut(G4double cut);
+    G4VPhysicalVolume* ReadGeometryCache() const;
+    void WriteGeometryCache(G4VPhysicalVolume* worldPV) const;
+
     G4GenericMessenger *fMessenger = nullptr;
     G4double detAsizeZ = 1.;
+    // Number of pixels per side and pixel pitch of the detectors A and B
+    // and number of segments of the detector C
+    G4int fNofPixelsA = 10;
+    G4int fNofPixelsB = 10;
+    G4double fPitchA;
+    G4double fPitchB;
+    G4int fNofSegmentsC = 100;
+    // Readout of the detectors: "volume" (one volume per pixel)
+    // or "virtual" (pixel computed from the hit position)
+    G4String fReadoutA = "volume";
+    G4String fReadoutB = "volume";
+    G4String fReadoutC = "volume";
+    // Overlaps check mode: "off", "full" or "cached"
+    G4String fCheckOverlaps = "full";
+    // Directory of the GDML geometry cache (no cache if empty)
+    G4String fGDMLCacheDir;
+    // Production cut in the detectors (FocalPlane region)
+    G4double fDetectorCut;
+    GeometryIndex fGeometryIndex;
 };
 
 }
@@ -34,11 +34,15 @@
 
 #include "G4VSensitiveDetector.hh"
 #include "EmCalorimeterHit.hh"
+#include "ChannelRange.hh"
+#include "G4ThreeVector.hh"
+
+#include <vector>
 
 class G4Step;
 class G4HCofThisEvent;
 class G4TouchableHistory;
-class G4GenericMessenger;
+class G4VTouchable;
 
 namespace ED
 {
@@ -46,18 +50,51 @@ namespace ED
 class EmCalorimeterSD : public G4VSensitiveDetector
 {
   public:
-    EmCalorimeterSD(const G4String& name);
+    EmCalorimeterSD(const G4String& name, const ChannelRange& channels);
     ~EmCalorimeterSD() override;
 
     void   Initialize(G4HCofThisEvent* hce) override;
     G4bool ProcessHits(G4Step* step, G4TouchableHistory* history) override;
     void   EndOfEvent(G4HCofThisEvent* hce) override;
 
+    const ChannelRange& GetChannels() const { return fChannels; }
+
+    // Add an energy deposit at a position of a sensitive volume
+    // (ProcessHits, and the electrons deposited locally by the
+    // StackingAction without being tracked)
+    void AddDeposit(const G4VTouchable* touchable,
+                    const G4ThreeVector& position, G4double edep);
+
+    // Virtual pixelisation: the SD is attached to a single volume and
+    // the channel is computed from the position of the energy deposit,
+    // either on a square grid of pixels in the local xy plane
+    // (centred on the volume) or in phi segments starting from phi = 0
+    void SetGridReadout(G4int nofPixels, G4double pitch);
+    void SetPhiReadout(G4int nofSegments);
+
   private:
+    enum class Readout { kVolume, kGrid, kPhi };
+
+    G4int FindSlot(G4int copyNumber) const;
+    G4int FindSlot(const G4VTouchable* touchable,
+                   const G4ThreeVector& position) const;
+
+    // Channels owned by this SD: the copy numbers firstCopyNo ...
+    // firstCopyNo + count - 1 are the slots 0 ... count - 1
+    ChannelRange fChannels;
+
+    Readout fReadout = Readout::kVolume;
+    G4int fNofPixels = 0;
+    G4double fInvPitch = 0.;
+    G4double fOrigin = 0.;
+    G4double fInvSegment = 0.;
+
     EmCalorimeterHitsCollection* fHitsCollection = nullptr;
-    G4int fNtupleRowCount = 0;  // Row count tracker
-    G4GenericMessenger *fMessenger = nullptr;
-    G4int fNsteps = 1;
+    G4int fHitsCollectionID = -1;
+    // Sparse accumulation: the dense energy array persists over events
+    // (the SD is thread-local) and only the touched slots are reset
+    std::vector<G4double> fEdep;
+    std::vector<G4int> fTouchedSlots;
 };
 
 }
@@ -32,12 +32,26 @@
 #define EventAction_h 1
 
 #include "G4UserEventAction.hh"
+#include "EventTracer.hh"
+#include "globals.hh"
+
+#include <vector>
 
 /// Event action class
+///
+/// It collects the hits of all calorimeter hits collections and
+/// writes one ntuple row per event with the detector IDs and energies
+/// of the fired detectors stored in vector columns, or one row per hit
+/// in the columnar output file.
+/// With /trace/enable, the span of each event is added to the trace
+/// of its thread.
 
 namespace ED
 {
 
+class ColumnarWriter;
+class SpectrumAccumulable;
+
 class EventAction : public G4UserEventAction
 {
   public:
@@ -46,6 +60,27 @@ class EventAction : public G4UserEventAction
 
     void  BeginOfEventAction(const G4Event* event) override;
     void    EndOfEventAction(const G4Event* event) override;
+
+    // The vectors are used as ntuple columns (see RunAction)
+    std::vector<G4int>&    GetDetectorIDs() { return fDetectorIDs; }
+    std::vector<G4double>& GetEnergies()    { return fEnergies; }
+
+    // If set, the hits are written in the columnar file instead of the ntuple
+    void SetColumnarWriter(ColumnarWriter* writer) { fColumnarWriter = writer; }
+    // If set, the hits energies are added in the spectra
+    void SetSpectra(SpectrumAccumulable* spectra) { fSpectra = spectra; }
+    // The per-hit output can be switched off (spectra only runs)
+    void SetWriteHits(G4bool writeHits) { fWriteHits = writeHits; }
+
+  private:
+    void RecordHits(const G4Event* event);
+
+    ColumnarWriter* fColumnarWriter = nullptr;
+    SpectrumAccumulable* fSpectra = nullptr;
+    G4bool fWriteHits = true;
+    std::vector<G4int>    fDetectorIDs;
+    std::vector<G4double> fEnergies;
+    EventTracer::Clock::time_point fEventStart;
 };
 
 }
@@ -0,0 +1,137 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+// $Id$
+//
+/// \file EventTracer.hh
+/// \brief Definition of the EventTracer class
+
+#ifndef EventTracer_h
+#define EventTracer_h 1
+
+#include "globals.hh"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class G4GenericMessenger;
+
+namespace ED
+{
+
+/// Timeline of the events and of the end of run phases of each thread.
+///
+/// With /trace/enable, each thread records the begin and end times of its
+/// events (EventAction) and of its output writing and merging (RunAction)
+/// in its own buffer, without lock. At the end of the run, the master
+/// writes the spans of all threads in <fileName>_run<N>.json in the Chrome
+/// trace format, which can be opened in Perfetto (ui.perfetto.dev) or
+/// chrome://tracing. The spans beyond /trace/maxSpans per thread are
+/// dropped and counted.
+/// The tracer is a master only object (see Logger.hh).
+
+class EventTracer
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    EventTracer();
+    ~EventTracer();
+
+    static EventTracer* Instance() { return fgInstance; }
+
+    static G4bool IsEnabled() { return fgEnabled.load(std::memory_order_relaxed); }
+    static Clock::time_point Now() { return Clock::now(); }
+
+    // Span of the current thread; the name must be a string literal
+    static void Add(const char* name, Clock::time_point start,
+                    Clock::time_point end, G4int eventID = -1);
+
+    // Called by the master run action, before the workers start
+    // their run and after they have finished it
+    void StartRun(G4int runID);
+    void EndRun();
+
+  private:
+    struct Span
+    {
+      const char* name;
+      G4int eventID;
+      Clock::time_point start;
+      Clock::time_point end;
+    };
+    struct Buffer
+    {
+      G4int threadID = -1;
+      std::vector<Span> spans;
+      std::size_t nofDropped = 0;
+    };
+
+    Buffer* GetBuffer();
+    void SetEnabled(G4bool enable);
+    G4bool Write(const G4String& fileName) const;
+
+    static EventTracer* fgInstance;
+    static std::atomic<G4bool> fgEnabled;
+
+    G4GenericMessenger* fMessenger = nullptr;
+    G4String fFileName = "trace";
+    G4int fMaxSpans = 1000000;
+    G4int fRunID = 0;
+    Clock::time_point fRunStart;
+
+    std::mutex fBuffersMutex;
+    std::vector<std::unique_ptr<Buffer>> fBuffers;
+};
+
+/// Adds the time of its scope to the trace of the current thread
+
+class TraceScope
+{
+  public:
+    explicit TraceScope(const char* name)
+    {
+      if ( ! EventTracer::IsEnabled() ) return;
+      fName = name;
+      fStart = EventTracer::Now();
+    }
+    ~TraceScope()
+    {
+      if ( fName ) EventTracer::Add(fName, fStart, EventTracer::Now());
+    }
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+  private:
+    const char* fName = nullptr;
+    EventTracer::Clock::time_point fStart;
+};
+
+}
+
+#endif
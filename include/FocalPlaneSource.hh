@@ -0,0 +1,81 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+// $Id$
+//
+/// \file FocalPlaneSource.hh
+/// \brief Definition of the FocalPlaneSource class
+
+#ifndef FocalPlaneSource_h
+#define FocalPlaneSource_h 1
+
+#include "G4VPrimaryGenerator.hh"
+#include "G4ThreeVector.hh"
+#include "FocalPlaneTable.hh"
+
+#include <memory>
+
+class G4GenericMessenger;
+
+namespace ED
+{
+
+/// Photons converging from a Laue lens on its focal plane.
+///
+/// For each photon, a bin of the focal plane table is sampled with its
+/// alias table, then the energy, the emission point on the lens annulus
+/// (at the focal length upstream of the focus) and the crossing point in
+/// the focal plane annulus; the photon starts where its path crosses the
+/// entrance plane. Its polarisation is the /focalPlane/polarization
+/// direction with the probability of the bin polarisation degree, and a
+/// random direction otherwise.
+/// The table is read from a file with /focalPlane/table (see
+/// FocalPlaneTable) or computed by the Laue lens model (/focalPlane/useLens).
+
+class FocalPlaneSource : public G4VPrimaryGenerator
+{
+  public:
+    FocalPlaneSource();
+    ~FocalPlaneSource() override;
+
+    void GeneratePrimaryVertex(G4Event* event) override;
+
+    void SetTable(std::shared_ptr<const FocalPlaneTable> table) { fTable = table; }
+    const FocalPlaneTable* GetTable() const { return fTable.get(); }
+
+  private:
+    void SetTableFile(const G4String& fileName);
+    void UseLens();
+
+    G4GenericMessenger* fMessenger = nullptr;
+    std::shared_ptr<const FocalPlaneTable> fTable;
+    G4ThreeVector fFocus;
+    G4double fEntranceZ;
+    G4ThreeVector fPolarisation;
+};
+
+}
+
+#endif
@@ -0,0 +1,95 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+// $Id$
+//
+/// \file FocalPlaneTable.hh
+/// \brief Definition of the FocalPlaneTable class
+
+#ifndef FocalPlaneTable_h
+#define FocalPlaneTable_h 1
+
+#include "AliasTable.hh"
+#include "globals.hh"
+
+#include <memory>
+#include <vector>
+
+namespace ED
+{
+
+/// Bin of the focal plane photon field: the photons of energy in
+/// [eMin, eMax] come from the lens annulus [lensRMin, lensRMax] and
+/// cross the focal plane in the annulus [spotRMin, spotRMax] around the
+/// focus, with the given linear polarisation degree; the weight is the
+/// relative rate of the bin.
+
+struct FocalPlaneBin
+{
+  G4double eMin;
+  G4double eMax;
+  G4double lensRMin;
+  G4double lensRMax;
+  G4double spotRMin;
+  G4double spotRMax;
+  G4double polarisation;
+  G4double weight;
+};
+
+/// Binned photon field of a Laue lens at its focal plane, with the alias
+/// table of its bins.
+///
+/// The table file is a text file with a "focalLength <mm>" line followed
+/// by one line per bin: "eMin eMax lensRMin lensRMax spotRMin spotRMax
+/// polarisation weight", energies in keV and lengths in mm ('#' starts
+/// a comment). The tables are loaded once and shared, read only, by the
+/// generators of all threads.
+
+class FocalPlaneTable
+{
+  public:
+    FocalPlaneTable(G4double focalLength, std::vector<FocalPlaneBin> bins);
+
+    // The table of a file, read at the first call
+    static std::shared_ptr<const FocalPlaneTable> Load(const G4String& fileName);
+    G4bool Write(const G4String& fileName) const;
+
+    // u uniform in [0, 1)
+    const FocalPlaneBin& SampleBin(G4double u) const
+    { return fBins[fAliasTable.Sample(u)]; }
+
+    G4double GetFocalLength() const { return fFocalLength; }
+    const std::vector<FocalPlaneBin>& GetBins() const { return fBins; }
+    G4double GetTotalWeight() const { return fAliasTable.GetTotalWeight(); }
+
+  private:
+    G4double fFocalLength;
+    std::vector<FocalPlaneBin> fBins;
+    AliasTable fAliasTable;
+};
+
+}
+
+#endif
@@ -0,0 +1,103 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+// $Id$
+//
+/// \file GeometryIndex.hh
+/// \brief Definition of the GeometryIndex class
+
+#ifndef GeometryIndex_h
+#define GeometryIndex_h 1
+
+#include "ChannelRange.hh"
+#include "LookupTable.hh"
+
+#include "G4ThreeVector.hh"
+#include "G4RotationMatrix.hh"
+#include "G4Transform3D.hh"
+
+#include <vector>
+
+class G4VPhysicalVolume;
+
+namespace ED
+{
+
+/// Global position of the detector channels.
+///
+/// The physical volumes tree is walked once from the world, composing the
+/// transformations of all the levels (parameterised volumes included);
+/// the global centre and rotation of each channel of the registered
+/// readouts are then kept in a lookup table indexed by channel.
+///  - volume readout: one channel per copy of the given logical volume,
+///    centred on its solid (mid radius and mid phi of a tube segment);
+///  - grid and phi readouts: the pixels and segments of the virtual readout
+///    (see EmCalorimeterSD) of the given logical volume.
+
+class GeometryIndex
+{
+  public:
+    GeometryIndex() = default;
+    ~GeometryIndex() = default;
+
+    void AddVolumeReadout(const G4String& volumeName, const ChannelRange& channels);
+    void AddGridReadout(const G4String& volumeName, const ChannelRange& channels,
+                        G4int nofPixels, G4double pitch);
+    void AddPhiReadout(const G4String& volumeName, const ChannelRange& channels,
+                       G4int nofSegments);
+    void Clear();
+
+    void Build(G4VPhysicalVolume* worldPV);
+
+    // O(1) queries by channel; return false if the channel is unknown
+    G4bool GetCentre(G4int channel, G4ThreeVector& centre) const;
+    G4bool GetTransform(G4int channel, G4ThreeVector& centre,
+                        G4RotationMatrix& rotation) const;
+    const lut::LookupTable& GetTable() const { return fTable; }
+
+  private:
+    enum class Kind { kVolume, kGrid, kPhi };
+    struct Readout
+    {
+      G4String volumeName;
+      ChannelRange channels;
+      Kind kind = Kind::kVolume;
+      G4int nofPixels = 0;
+      G4double pitch = 0.;
+    };
+
+    void Walk(G4VPhysicalVolume* physVol, const G4Transform3D& motherTransform,
+              std::vector<lut::Entry>& entries) const;
+    void AddEntries(const Readout& readout, G4VPhysicalVolume* physVol,
+                    const G4Transform3D& transform,
+                    std::vector<lut::Entry>& entries) const;
+
+    std::vector<Readout> fReadouts;
+    lut::LookupTable fTable;
+};
+
+}
+
+#endif
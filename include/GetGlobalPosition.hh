@@ -1 +0,0 @@
-G4ThreeVector GetGlobalPosition(G4VPhysicalVolume* volume);
\ No newline at end of file
@@ -0,0 +1,107 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+// $Id$
+//
+/// \file LaueLens.hh
+/// \brief Definition of the LaueLens class
+
+#ifndef LaueLens_h
+#define LaueLens_h 1
+
+#include "FocalPlaneTable.hh"
+#include "globals.hh"
+
+#include <memory>
+#include <vector>
+
+class G4GenericMessenger;
+
+namespace ED
+{
+
+/// Response of a Laue lens made of concentric rings of mosaic crystal
+/// tiles, tabulated as a focal plane table for the FocalPlaneSource.
+///
+/// A ring of radius r diffracts towards the focus, at the focal length F,
+/// the photons of nominal energy hc/(2 d sin(theta_B)), with the Bragg
+/// angle theta_B = atan(r/F)/2. A photon of energy E is diffracted by the
+/// crystallites tilted by theta(E) - theta_B, with the Gaussian mosaic
+/// distribution of the crystal (FWHM mosaicity) times the peak
+/// reflectivity; its path is then deviated by twice this angle from the
+/// focus direction, and the flat tile spreads it over its size. For each
+/// energy bin and ring, the effective area and the radial point spread
+/// function in the focal plane are integrated numerically; the bin
+/// weights are the effective area times a power law source spectrum.
+///
+/// The lens is a master only object (see Logger.hh): /lens/build computes
+/// the table, which is then shared by the sources of all threads
+/// (/focalPlane/useLens).
+
+class LaueLens
+{
+  public:
+    LaueLens();
+    ~LaueLens();
+
+    static LaueLens* Instance() { return fgInstance; }
+
+    struct Ring
+    {
+      G4double radius;
+      G4double dSpacing;
+      G4double mosaicity;     // FWHM
+      G4double tileSize;
+      G4double reflectivity;  // peak reflectivity
+    };
+
+    void AddRing(const Ring& ring) { fRings.push_back(ring); }
+    void Build();
+
+    std::shared_ptr<const FocalPlaneTable> GetTable() const { return fTable; }
+
+  private:
+    void AddRingCommand(const G4String& parameters);
+    void ClearRings() { fRings.clear(); }
+    void WriteTable(const G4String& fileName);
+
+    static LaueLens* fgInstance;
+
+    G4GenericMessenger* fMessenger = nullptr;
+    std::vector<Ring> fRings;
+    G4double fFocalLength;
+    G4double fEMin;
+    G4double fEMax;
+    G4int fNofEnergyBins = 100;
+    G4double fSpotRMax;
+    G4int fNofSpotBins = 20;
+    G4double fSpectralIndex = 0.;
+    G4double fPolarisation = 0.;
+    std::shared_ptr<const FocalPlaneTable> fTable;
+};
+
+}
+
+#endif
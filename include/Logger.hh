@@ -0,0 +1,159 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+// $Id$
+//
+/// \file Logger.hh
+/// \brief Definition of the Logger class and of the LAUE_LOG macros
+
+#ifndef Logger_h
+#define Logger_h 1
+
+#include "globals.hh"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+class G4GenericMessenger;
+
+// Messages below this level are removed at compile time (0 debug, 1 info,
+// 2 warning, 3 error); set by CMake to 1 in the optimised builds
+#ifndef LAUE_LOG_MIN_LEVEL
+#define LAUE_LOG_MIN_LEVEL 0
+#endif
+
+// The message is a stream expression, formatted only if the level is enabled:
+//   LAUE_LOG_INFO("Hit in the detector " << id);
+#define LAUE_LOG(level, message)                                            \
+  do {                                                                      \
+    if ( (int)(level) >= LAUE_LOG_MIN_LEVEL &&                              \
+         ED::Logger::IsEnabled(level) ) {                                   \
+      std::ostringstream laueLogStream;                                     \
+      laueLogStream << message;                                             \
+      ED::Logger::Log(level, laueLogStream.str());                          \
+    }                                                                       \
+  } while (0)
+
+#define LAUE_LOG_DEBUG(message)   LAUE_LOG(ED::LogLevel::kDebug, message)
+#define LAUE_LOG_INFO(message)    LAUE_LOG(ED::LogLevel::kInfo, message)
+#define LAUE_LOG_WARNING(message) LAUE_LOG(ED::LogLevel::kWarning, message)
+#define LAUE_LOG_ERROR(message)   LAUE_LOG(ED::LogLevel::kError, message)
+
+namespace ED
+{
+
+enum class LogLevel { kDebug = 0, kInfo = 1, kWarning = 2, kError = 3 };
+
+/// Asynchronous logger.
+///
+/// During a run, each thread appends its messages to its own ring buffer
+/// (single producer, single consumer, no lock) and a background thread
+/// writes them in the run log file <fileName>_run<N>.log; the messages
+/// of a full buffer are dropped and counted. Out of a run, or without
+/// file name, the messages are printed on G4cout.
+///
+/// Master only objects: the logger, like the event tracer and the Laue
+/// lens model, is created once by the main program and its state is
+/// shared by all threads, so its commands (/log/) are executed on the
+/// master only, not broadcast to the workers (SetMasterOnly()).
+
+class Logger
+{
+  public:
+    Logger();
+    ~Logger();
+
+    static Logger* Instance() { return fgInstance; }
+
+    static G4bool IsEnabled(LogLevel level)
+    { return (int)level >= fgLevel.load(std::memory_order_relaxed); }
+    static void Log(LogLevel level, const std::string& message);
+
+    // Interval (in events) of the per-event printing
+    static G4int GetPrintInterval()
+    { return fgPrintInterval.load(std::memory_order_relaxed); }
+    static G4bool IsPrintEvent(G4int eventID)
+    { return eventID % GetPrintInterval() == 0; }
+
+    // Called by the master run action
+    void OpenFile(G4int runID);
+    void CloseFile();
+
+  private:
+    // Fixed size messages, longer messages are truncated
+    static constexpr std::size_t kMessageSize = 240;
+    static constexpr std::size_t kRingSize = 1024;   // power of 2
+
+    struct Record
+    {
+      LogLevel level;
+      G4int length;
+      char text[kMessageSize];
+    };
+    struct Ring
+    {
+      G4int threadID = -1;
+      std::atomic<uint64_t> head { 0 };   // written by the thread
+      std::atomic<uint64_t> tail { 0 };   // written by the writer
+      Record records[kRingSize];
+    };
+
+    Ring* GetRing();
+    void Push(LogLevel level, const std::string& message);
+    std::size_t Drain();
+    void WriterLoop();
+
+    void SetLevel(const G4String& level);
+    void SetPrintInterval(G4int interval);
+
+    static Logger* fgInstance;
+    static std::atomic<G4int> fgLevel;
+    static std::atomic<G4int> fgPrintInterval;
+
+    G4GenericMessenger* fMessenger = nullptr;
+    G4String fFileName = "laueDet";
+
+    std::mutex fRingsMutex;
+    std::vector<std::unique_ptr<Ring>> fRings;
+    std::atomic<G4bool> fOpen { false };
+    std::atomic<G4bool> fStop { false };
+    std::atomic<uint64_t> fNofDropped { 0 };
+    std::thread fWriter;
+    std::unique_ptr<std::ostream> fFile;
+};
+
+/// Executes the commands of the directory (such as "/log/") on the master
+/// only; to be called once all the commands of a master only object are
+/// declared
+void SetMasterOnly(const G4String& directory);
+
+}
+
+#endif
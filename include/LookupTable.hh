@@ -0,0 +1,167 @@
+/// \file LookupTable.hh
+/// \brief Detector lookup table: global centre and rotation of each channel
+///
+/// The table is filled by the GeometryIndex from the constructed geometry
+/// and written in two formats:
+///  - lookup_table.txt: "detID,x,y,z" lines with the centre in cm
+///    (the historical format);
+///  - lookup_table.bin: a LookupFileHeader followed by one Entry per
+///    channel, sorted by channel, with the centre in mm and the rotation
+///    matrix (local to global, row major) of the channel volume.
+/// Like the columnar format, it does not depend on Geant4 so that the
+/// reconstruction programs can query the positions with Find().
+
+#ifndef LookupTable_h
+#define LookupTable_h 1
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ED
+{
+namespace lut
+{
+
+constexpr char     kMagic[8] = { 'L', 'A', 'U', 'E', 'L', 'U', 'T', '1' };
+constexpr uint32_t kVersion = 1;
+
+struct LookupFileHeader
+{
+  char     magic[8];
+  uint32_t version;
+  uint32_t nofEntries;
+};
+
+struct Entry
+{
+  int32_t channel;
+  int32_t reserved;
+  double  centre[3];        // mm
+  double  rotation[9];      // row major
+};
+
+static_assert(sizeof(LookupFileHeader) == 16, "unexpected LookupFileHeader layout");
+static_assert(sizeof(Entry) == 104, "unexpected Entry layout");
+
+/// Entries indexed by channel: Find() is a single array access
+
+class LookupTable
+{
+  public:
+    LookupTable() = default;
+    explicit LookupTable(std::vector<Entry> entries);
+
+    const Entry* Find(int32_t channel) const;
+    const std::vector<Entry>& GetEntries() const { return fEntries; }
+    std::size_t GetSize() const { return fEntries.size(); }
+
+    void WriteCsv(const std::string& fileName) const;
+    void Write(const std::string& fileName) const;
+    static LookupTable Read(const std::string& fileName);
+
+  private:
+    std::vector<Entry> fEntries;
+    // Position in fEntries of the channels fFirstChannel, fFirstChannel+1 ...
+    // (-1 if the channel is not in the table)
+    std::vector<int32_t> fIndex;
+    int32_t fFirstChannel = 0;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+inline LookupTable::LookupTable(std::vector<Entry> entries)
+ : fEntries(std::move(entries))
+{
+  std::sort(fEntries.begin(), fEntries.end(),
+            [](const Entry& a, const Entry& b) { return a.channel < b.channel; });
+  if ( fEntries.empty() ) return;
+
+  fFirstChannel = fEntries.front().channel;
+  fIndex.assign(fEntries.back().channel - fFirstChannel + 1, -1);
+  for ( std::size_t i=0; i<fEntries.size(); ++i ) {
+    fIndex[fEntries[i].channel - fFirstChannel] = (int32_t)i;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+inline const Entry* LookupTable::Find(int32_t channel) const
+{
+  auto offset = (int64_t)channel - fFirstChannel;
+  if ( offset < 0 || offset >= (int64_t)fIndex.size() || fIndex[offset] < 0 ) {
+    return nullptr;
+  }
+  return &fEntries[fIndex[offset]];
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+inline void LookupTable::WriteCsv(const std::string& fileName) const
+{
+  std::ofstream output(fileName);
+  if ( ! output.is_open() ) {
+    throw std::runtime_error("lut: cannot open " + fileName);
+  }
+  output << "# Look up table (det,x,y,z) x,y,z in cm\n";
+  output << "# detID  x(cm) y(cm) z(cm)\n";
+  for ( const auto& entry : fEntries ) {
+    output << entry.channel << "," << entry.centre[0]/10. << ","
+           << entry.centre[1]/10. << "," << entry.centre[2]/10. << "\n";
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+inline void LookupTable::Write(const std::string& fileName) const
+{
+  std::ofstream output(fileName, std::ios::binary);
+  if ( ! output.is_open() ) {
+    throw std::runtime_error("lut: cannot open " + fileName);
+  }
+  LookupFileHeader header {};
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.nofEntries = (uint32_t)fEntries.size();
+  output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  output.write(reinterpret_cast<const char*>(fEntries.data()),
+               fEntries.size()*sizeof(Entry));
+  if ( ! output ) {
+    throw std::runtime_error("lut: cannot write " + fileName);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+inline LookupTable LookupTable::Read(const std::string& fileName)
+{
+  std::ifstream input(fileName, std::ios::binary);
+  if ( ! input.is_open() ) {
+    throw std::runtime_error("lut: cannot open " + fileName);
+  }
+
+  LookupFileHeader header {};
+  input.read(reinterpret_cast<char*>(&header), sizeof(header));
+  if ( ! input || std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+       header.version != kVersion ) {
+    throw std::runtime_error("lut: " + fileName + " is not a lookup table file");
+  }
+
+  std::vector<Entry> entries(header.nofEntries);
+  input.read(reinterpret_cast<char*>(entries.data()),
+             entries.size()*sizeof(Entry));
+  if ( ! input ) {
+    throw std::runtime_error("lut: " + fileName + " is truncated");
+  }
+  return LookupTable(std::move(entries));
+}
+
+}
+}
+
+#endif
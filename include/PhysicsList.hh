@@ -0,0 +1,106 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+// $Id$
+//
+/// \file PhysicsList.hh
+/// \brief Definition of the PhysicsList class
+
+#ifndef PhysicsList_h
+#define PhysicsList_h 1
+
+#include "G4VModularPhysicsList.hh"
+#include "G4VStateDependent.hh"
+#include "G4Timer.hh"
+#include "globals.hh"
+
+class G4GenericMessenger;
+class G4VPhysicsConstructor;
+
+namespace ED
+{
+
+/// Modular physics list made of one electromagnetic constructor, selected
+/// with the -p option of laueDet or with /physics/em (before
+/// /run/initialize):
+///  - livermorePolarized (default): Livermore models with the
+///    polarisation of the photons, for the polarimetry runs;
+///  - livermore, penelope: low energy models without polarisation;
+///  - standard, standard_opt4: standard models (option 0 is the fastest),
+///    for the effective area and background runs.
+/// The default cut (1 mm) is the cut of the vacuum world; the detectors
+/// have their own cut (FocalPlane region, /detector/detectorCut).
+///
+/// With /physics/tableCache <directory>, the physics tables built by the
+/// first job are stored in <directory>/<hash> and retrieved by the next
+/// jobs, where the hash is computed, when the first run starts, from the
+/// Geant4 version, the electromagnetic constructor and parameters, the
+/// materials and the production cuts of all regions. Geant4 checks again
+/// the materials and cuts when it retrieves the tables and builds them
+/// if they differ. The time of the tables and the startup time of the
+/// job are printed when the first run starts.
+
+class PhysicsList : public G4VModularPhysicsList, public G4VStateDependent
+{
+  public:
+    explicit PhysicsList(const G4String& emName = "livermorePolarized");
+    ~PhysicsList() override;
+
+    // The names accepted by SetEmPhysics
+    static G4String GetEmNames();
+    static G4bool IsEmName(const G4String& name);
+
+    void SetEmPhysics(const G4String& name);
+    const G4String& GetEmName() const { return fEmName; }
+
+    // The tables are retrieved or stored around their building,
+    // in the Init state which precedes the first run (master only)
+    G4bool Notify(G4ApplicationState requestedState) override;
+
+  private:
+    static G4VPhysicsConstructor* CreateEmPhysics(const G4String& name);
+
+    G4String GetPhysicsParameters() const;
+    void PrepareTableCache();
+    void StoreTableCache();
+
+    G4GenericMessenger* fMessenger = nullptr;
+    G4String fEmName;
+
+    G4String fTableCache;
+    G4String fTableDirectory;
+    G4String fTableParameters;
+    G4bool fRetrieveTables = false;
+    G4bool fStoreTables = false;
+    G4bool fTablesReady = false;
+    G4bool fBuildingTables = false;
+    G4Timer fTablesTimer;
+};
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,74 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+// $Id$
+//
+/// \file PixelParameterisation.hh
+/// \brief Definition of the PixelParameterisation class
+
+#ifndef PixelParameterisation_h
+#define PixelParameterisation_h 1
+
+#include "G4VPVParameterisation.hh"
+#include "G4ThreeVector.hh"
+
+class G4VPhysicalVolume;
+
+namespace ED
+{
+
+/// Parameterisation of a square array of nofPixels x nofPixels pixels
+/// with the given pitch, centred in its mother volume.
+/// The pixel (i,j) (i along x, j along y) has the copy number i*nofPixels+j.
+
+class PixelParameterisation : public G4VPVParameterisation
+{
+  public:
+    PixelParameterisation(G4int nofPixels, G4double pitch);
+    ~PixelParameterisation() override = default;
+
+    void ComputeTransformation(G4int copyNo,
+                               G4VPhysicalVolume* physVol) const override;
+
+    // Centre of the pixel in the mother frame
+    G4ThreeVector GetPixelCentre(G4int copyNo) const
+    {
+      auto i = copyNo / fNofPixels;
+      auto j = copyNo % fNofPixels;
+      return G4ThreeVector(fOrigin + i*fPitch, fOrigin + j*fPitch, 0.);
+    }
+
+    G4int GetNofPixels() const { return fNofPixels; }
+    G4double GetPitch() const { return fPitch; }
+
+  private:
+    G4int fNofPixels;
+    G4double fPitch;
+    G4double fOrigin;   // centre of the first pixel
+};
+
+}
+
+#endif
@@ -3,15 +3,29 @@
 
 #include "G4VUserPrimaryGeneratorAction.hh"
 #include "DetectorConstruction.hh"
+#include "AcceptanceFilter.hh"
 
 // Mandatory user class that defines the properties of the
 // particle gun and run initialization
 // Derived from the G4VUserPrimaryGeneratorAction initialisation
 // abstract base class.
+// The primaries are generated by the General Particle Source (/gps/)
+// or by the Laue lens focal plane source (/focalPlane/), selected
+// with /generator/type.
+// With /generator/acceptance, the events whose primaries cannot reach a
+// detector (see AcceptanceFilter) are discarded (left without primaries)
+// or resampled; the total number of samples (tries) normalises the
+// results, the weight of the accepted events is unchanged.
 
 class G4GeneralParticleSource;
+class G4GenericMessenger;
 class G4Event;
 
+namespace ED
+{
+class FocalPlaneSource;
+}
+
 class PrimaryGeneratorAction : public G4VUserPrimaryGeneratorAction
 {
 public:
@@ -21,12 +35,23 @@ public:
 public:
     // This method generates the primary particles
     void GeneratePrimaries(G4Event* anEvent);
+
+    // Number of primaries samples since the start of the thread
+    G4double GetNofSamples() const { return nofSamples; }
     
+private:
+    void GenerateEvent(G4Event* anEvent);
+    G4int GenerateAcceptedEvent(G4Event* anEvent);
     
 private:
     G4GeneralParticleSource*    particleGun;
+    ED::FocalPlaneSource*       focalPlaneSource;
+    G4GenericMessenger*         messenger;
+    G4String                    generatorType = "gps";
+    G4String                    acceptanceMode = "off";
+    G4int                       maxTries = 1000;
+    G4double                    nofSamples = 0.;
+    ED::AcceptanceFilter        acceptanceFilter;
 };
 
 #endif
-
-
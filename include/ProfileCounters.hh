@@ -0,0 +1,164 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+// $Id$
+//
+/// \file ProfileCounters.hh
+/// \brief Definition of the ProfileCounters class and of the LAUE_PROFILE macros
+
+#ifndef ProfileCounters_h
+#define ProfileCounters_h 1
+
+#include "G4VAccumulable.hh"
+#include "globals.hh"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+
+// The counters are compiled with the LAUE_PROFILING CMake option and
+// switched on at run time with /profile/enable:
+//   LAUE_PROFILE_SCOPE(ED::ProfileCounter::kProcessHits);
+// times the rest of the enclosing block.
+#ifdef LAUE_PROFILING
+#define LAUE_PROFILE_CONCAT(a, b) a##b
+#define LAUE_PROFILE_NAME(line) LAUE_PROFILE_CONCAT(laueProfileScope, line)
+#define LAUE_PROFILE_SCOPE(counter) ED::ProfileScope LAUE_PROFILE_NAME(__LINE__)(counter)
+#else
+#define LAUE_PROFILE_SCOPE(counter)
+#endif
+
+namespace ED
+{
+
+enum class ProfileCounter
+{
+  kGeneratePrimaries,
+  kSteppingA,          // steps in the sensitive volumes of each detector,
+                       // without ProcessHits
+  kSteppingB,
+  kSteppingC,
+  kSteppingOther,      // steps in the other volumes
+  kProcessHits,
+  kEndOfEvent,
+  kOutputFill,         // ntuple or columnar rows of an event
+  kOutputWrite,        // output files writing at the end of the run
+  kNofCounters
+};
+
+/// Cumulative time and number of calls of the hot paths.
+///
+/// Each thread fills its own counters (the instance of its RunAction);
+/// they are summed by the G4AccumulableManager on the master, which
+/// prints them as a table and writes them in a JSON file.
+
+class ProfileCounters : public G4VAccumulable
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+    static constexpr std::size_t kNofCounters
+      = (std::size_t)ProfileCounter::kNofCounters;
+
+    ProfileCounters(const G4String& name);
+    ~ProfileCounters() override = default;
+
+    // The counters of the current thread
+    static ProfileCounters* Instance() { return fgInstance; }
+    static void SetInstance(ProfileCounters* counters) { fgInstance = counters; }
+
+    static G4bool IsEnabled() { return fgEnabled.load(std::memory_order_relaxed); }
+    static void SetEnabled(G4bool enabled) { fgEnabled = enabled; }
+
+    void Add(ProfileCounter counter, Clock::duration time)
+    {
+      fTimes[(std::size_t)counter] += time.count();
+      ++fCalls[(std::size_t)counter];
+      // ProcessHits is called inside a step
+      if ( counter == ProfileCounter::kProcessHits ) fNestedTime += time;
+    }
+
+    // The steps are timed from the previous step (or the event start),
+    // without the time of the counters nested in the step, so that the
+    // counters do not overlap (the stepping and stacking actions are
+    // counted in the step)
+    void StartStepping()
+    {
+      fLastStep = Clock::now();
+      fNestedTime = Clock::duration::zero();
+    }
+    void AddStep(ProfileCounter counter)
+    {
+      auto now = Clock::now();
+      Add(counter, now - fLastStep - fNestedTime);
+      fLastStep = now;
+      fNestedTime = Clock::duration::zero();
+    }
+
+    void Merge(const G4VAccumulable& other) override;
+    void Reset() override;
+
+    // wallTime: event loop duration, used for the fraction of the threads time
+    void Print(G4double wallTime) const;
+    G4bool WriteJson(const G4String& fileName, G4double wallTime) const;
+
+  private:
+    static G4ThreadLocal ProfileCounters* fgInstance;
+    static std::atomic<G4bool> fgEnabled;
+
+    std::array<Clock::rep, kNofCounters> fTimes {};
+    std::array<G4long, kNofCounters> fCalls {};
+    G4int fNofThreads = 0;
+    Clock::time_point fLastStep;
+    Clock::duration fNestedTime {};
+};
+
+/// Adds the time of its scope to a counter of the current thread
+
+class ProfileScope
+{
+  public:
+    explicit ProfileScope(ProfileCounter counter)
+    {
+      if ( ! ProfileCounters::IsEnabled() ) return;
+      fCounters = ProfileCounters::Instance();
+      fCounter = counter;
+      fStart = ProfileCounters::Clock::now();
+    }
+    ~ProfileScope()
+    {
+      if ( fCounters ) fCounters->Add(fCounter, ProfileCounters::Clock::now() - fStart);
+    }
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+  private:
+    ProfileCounters* fCounters = nullptr;
+    ProfileCounter fCounter = ProfileCounter::kNofCounters;
+    ProfileCounters::Clock::time_point fStart;
+};
+
+}
+
+#endif
@@ -32,23 +32,70 @@
 #define RunAction_h 1
 
 #include "G4UserRunAction.hh"
+#include "G4Accumulable.hh"
+#include "SpectrumAccumulable.hh"
+#include "ProfileCounters.hh"
 #include "globals.hh"
 
 class G4Run;
+class G4GenericMessenger;
 
 /// Run action class
+///
+/// The output file format and the ntuple merging mode are set with
+/// the /output/ commands. When merging is switched off, each worker
+/// thread writes its own file (events_t<N>.*), which can be merged
+/// offline with the laueMerge tool. With the lcol format, each worker
+/// writes the hits in its own columnar binary file (see ColumnarFormat.hh).
+/// Optionally, the energy spectra of all detectors are accumulated in
+/// memory and written by the master in spectra.lspc; the per-hit output
+/// can then be switched off with /output/hits false.
+/// With /profile/enable, the hot paths profile counters of all threads
+/// are printed by the master at the end of the run. With /trace/enable,
+/// the event loop and the end of run phases of each thread are added to
+/// the events timeline (see EventTracer).
 
 namespace ED
 {
 
+class EventAction;
+class ColumnarWriter;
+
 class RunAction : public G4UserRunAction
 {
   public:
-    RunAction();
+    RunAction(EventAction* eventAction = nullptr);
     ~RunAction() override;
 
     void BeginOfRunAction(const G4Run*) override;
     void   EndOfRunAction(const G4Run*) override;
+
+  private:
+    void CloseOutput(const G4Run* run);
+    void WriteResults(const G4Run* run);
+    void SetProfiling(G4bool enable);
+
+    EventAction* fEventAction = nullptr;
+    G4GenericMessenger* fMessenger = nullptr;
+    ColumnarWriter* fColumnarWriter = nullptr;
+    G4String fFileType = "root";
+    G4bool fMergeNtuples = true;
+    G4bool fWriteHits = true;
+
+    SpectrumAccumulable fSpectra;
+    G4bool fFillSpectra = false;
+    G4int fSpectrumNofBins = 1000;
+    G4double fSpectrumEMax;
+
+    ProfileCounters fProfile;
+    G4GenericMessenger* fProfileMessenger = nullptr;
+    G4String fProfileFileName = "profile.json";
+    ProfileCounters::Clock::time_point fRunStart;
+
+    // Number of primaries samples of the primary generator
+    // (more than the number of events with /generator/acceptance resample)
+    G4Accumulable<G4double> fNofSamples;
+    G4double fFirstSample = 0.;
 };
 
 }
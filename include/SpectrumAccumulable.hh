@@ -0,0 +1,92 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+// $Id$
+//
+/// \file SpectrumAccumulable.hh
+/// \brief Definition of the SpectrumAccumulable class
+
+#ifndef SpectrumAccumulable_h
+#define SpectrumAccumulable_h 1
+
+#include "G4VAccumulable.hh"
+#include "ChannelRange.hh"
+
+#include <vector>
+
+namespace ED
+{
+
+/// Per-detector energy spectra accumulated in memory.
+///
+/// The counts are stored in one contiguous [channel][bin] array, one
+/// per thread; the worker arrays are merged in the master by the
+/// G4AccumulableManager and written as one block (see SpectrumFile.hh).
+
+class SpectrumAccumulable : public G4VAccumulable
+{
+  public:
+    SpectrumAccumulable(const G4String& name);
+    ~SpectrumAccumulable() override = default;
+
+    // Define the channels and the binning; the counts are reset
+    void Configure(const std::vector<ChannelRange>& channels,
+                   G4int nofBins, G4double eMax);
+
+    inline void Fill(G4int channel, G4double edep);
+    void AddEvent() { ++fNofEvents; }
+
+    void Merge(const G4VAccumulable& other) override;
+    void Reset() override;
+
+    // nofSamples: number of primaries samples of the run
+    G4bool Write(const G4String& fileName, G4long nofSamples) const;
+
+  private:
+    G4long* FindSpectrum(G4int channel);
+
+    std::vector<ChannelRange> fChannels;
+    std::vector<G4int> fFirstRows;   // of each channel range
+    G4int fNofBins = 0;
+    G4double fEMax = 0.;
+    G4double fInvBinWidth = 0.;
+    std::vector<G4long> fCounts;
+    G4long fNofEvents = 0;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+inline void SpectrumAccumulable::Fill(G4int channel, G4double edep)
+{
+  auto bin = (G4int)(edep*fInvBinWidth);
+  if ( bin < 0 || bin >= fNofBins ) return;
+
+  auto spectrum = FindSpectrum(channel);
+  if ( spectrum ) ++spectrum[bin];
+}
+
+}
+
+#endif
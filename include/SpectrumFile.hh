@@ -0,0 +1,110 @@
+/// \file SpectrumFile.hh
+/// \brief Layout and header-only reader of the laueDet spectra file (.lspc)
+///
+/// The file contains the energy spectra of all detectors in one block:
+///  - a SpectrumFileHeader;
+///  - the detector IDs (int32), one per channel;
+///  - the counts of channel 0 bins 0..nofBins-1, channel 1, ...,
+///    stored with countWidth bytes (4 or 8, unsigned).
+/// The bins are uniform between eMin and eMax (keV). The spectra are
+/// normalised by nofSamples, the number of primaries samples (more than
+/// the number of events with /generator/acceptance resample); the
+/// version 1 files, without nofSamples, are read with nofSamples equal
+/// to nofEvents.
+/// Like the columnar format, it does not depend on Geant4.
+
+#ifndef SpectrumFile_h
+#define SpectrumFile_h 1
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace ED
+{
+namespace lspc
+{
+
+constexpr char kMagic[8] = { 'L', 'A', 'U', 'E', 'S', 'P', 'C', '2' };
+constexpr char kMagicV1[8] = { 'L', 'A', 'U', 'E', 'S', 'P', 'C', '1' };
+constexpr std::size_t kHeaderSizeV1 = 48;
+
+struct SpectrumFileHeader
+{
+  char     magic[8];
+  uint32_t nofChannels;
+  uint32_t nofBins;
+  uint32_t countWidth;
+  uint32_t reserved;
+  double   eMin;            // keV
+  double   eMax;            // keV
+  uint64_t nofEvents;
+  uint64_t nofSamples;      // version 2
+};
+
+static_assert(sizeof(SpectrumFileHeader) == 56, "unexpected SpectrumFileHeader layout");
+
+/// Spectra read in memory
+
+struct Spectra
+{
+  SpectrumFileHeader header {};
+  std::vector<int32_t> detectorIDs;
+  std::vector<uint64_t> counts;    // [channel][bin]
+
+  const uint64_t* GetSpectrum(std::size_t channel) const
+  { return counts.data() + channel*header.nofBins; }
+  double GetBinWidth() const
+  { return (header.eMax - header.eMin)/header.nofBins; }
+};
+
+inline Spectra ReadSpectra(const std::string& fileName)
+{
+  std::ifstream input(fileName, std::ios::binary);
+  if ( ! input.is_open() ) {
+    throw std::runtime_error("lspc: cannot open " + fileName);
+  }
+
+  Spectra spectra;
+  auto& header = spectra.header;
+  input.read(reinterpret_cast<char*>(&header), kHeaderSizeV1);
+  auto isV1 = std::memcmp(header.magic, kMagicV1, sizeof(kMagicV1)) == 0;
+  if ( ! input ||
+       ( ! isV1 && std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ) ||
+       ( header.countWidth != 4 && header.countWidth != 8 ) ) {
+    throw std::runtime_error("lspc: " + fileName + " is not a spectra file");
+  }
+  if ( isV1 ) {
+    header.nofSamples = header.nofEvents;
+  }
+  else {
+    input.read(reinterpret_cast<char*>(&header.nofSamples), sizeof(header.nofSamples));
+  }
+
+  spectra.detectorIDs.resize(header.nofChannels);
+  input.read(reinterpret_cast<char*>(spectra.detectorIDs.data()),
+             header.nofChannels*sizeof(int32_t));
+
+  std::size_t size = std::size_t(header.nofChannels)*header.nofBins;
+  spectra.counts.resize(size);
+  if ( header.countWidth == 8 ) {
+    input.read(reinterpret_cast<char*>(spectra.counts.data()), size*8);
+  }
+  else {
+    std::vector<uint32_t> counts(size);
+    input.read(reinterpret_cast<char*>(counts.data()), size*4);
+    spectra.counts.assign(counts.begin(), counts.end());
+  }
+  if ( ! input ) {
+    throw std::runtime_error("lspc: " + fileName + " is truncated");
+  }
+  return spectra;
+}
+
+}
+}
+
+#endif
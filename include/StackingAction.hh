@@ -0,0 +1,74 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+// $Id$
+//
+/// \file StackingAction.hh
+/// \brief Definition of the StackingAction class
+
+#ifndef StackingAction_h
+#define StackingAction_h 1
+
+#include "G4UserStackingAction.hh"
+#include "globals.hh"
+
+class G4GenericMessenger;
+
+namespace ED
+{
+
+/// Stacking action class
+///
+/// With /stacking/localDeposit, the secondary electrons created in a
+/// sensitive volume with a range below /stacking/maxRange (or a kinetic
+/// energy below /stacking/maxEnergy) are not tracked: their kinetic
+/// energy is added to the pixel where they are created and they are
+/// killed. At our energies their range in CZT is much shorter than the
+/// pixel pitch, so the pixel which records the energy does not change,
+/// while their steps are most of the tracking time. The energy they would
+/// have carried out of the pixel (bremsstrahlung and fluorescence photons,
+/// electrons crossing the pixel border) is deposited in the pixel.
+/// The positrons are always tracked (their annihilation photons escape).
+
+class StackingAction : public G4UserStackingAction
+{
+  public:
+    StackingAction();
+    ~StackingAction() override;
+
+    G4ClassificationOfNewTrack ClassifyNewTrack(const G4Track* track) override;
+
+  private:
+    G4GenericMessenger* fMessenger = nullptr;
+    G4bool fLocalDeposit = false;
+    G4double fMaxRange = 0.;
+    G4double fMaxEnergy = 0.;
+};
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
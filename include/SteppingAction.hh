@@ -0,0 +1,80 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+// $Id$
+//
+/// \file SteppingAction.hh
+/// \brief Definition of the SteppingAction class
+
+#ifndef SteppingAction_h
+#define SteppingAction_h 1
+
+#include "G4UserSteppingAction.hh"
+#include "AcceptanceFilter.hh"
+#include "ProfileCounters.hh"
+
+#include <utility>
+#include <vector>
+
+class G4GenericMessenger;
+class G4VSensitiveDetector;
+
+namespace ED
+{
+
+/// Stepping action class
+///
+/// The particles which leave a detector for the world volume and whose
+/// straight path does not reach another detector are killed
+/// (/stepping/killEscaping), as they would leave the vacuum world without
+/// any other hit.
+/// With the profiling counters, the time of each step is added to the
+/// counter of the detector of its sensitive volume (or of the other volumes).
+
+class SteppingAction : public G4UserSteppingAction
+{
+  public:
+    SteppingAction();
+    ~SteppingAction() override;
+
+    void UserSteppingAction(const G4Step* step) override;
+
+  private:
+    void KillEscaping(const G4Step* step);
+    ProfileCounter GetCounter(const G4VSensitiveDetector* sd);
+
+    G4GenericMessenger* fMessenger = nullptr;
+    G4bool fKillEscaping = true;
+    AcceptanceFilter fAcceptanceFilter;
+
+    // The counters of the sensitive detectors met so far
+    std::vector<std::pair<const G4VSensitiveDetector*, ProfileCounter>> fCounters;
+};
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
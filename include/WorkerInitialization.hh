@@ -0,0 +1,75 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+// $Id$
+//
+/// \file WorkerInitialization.hh
+/// \brief Definition of the WorkerInitialization class
+
+#ifndef WorkerInitialization_h
+#define WorkerInitialization_h 1
+
+#include "G4UserWorkerInitialization.hh"
+#include "globals.hh"
+
+#include <vector>
+
+class G4GenericMessenger;
+
+namespace ED
+{
+
+/// Worker threads setup, with the /threads/ commands (to be applied
+/// before the first run, on the master):
+///  - affinity none|core|numa: each worker thread is pinned, when it
+///    starts, to one core or to the cores of one NUMA node (the workers
+///    are distributed in turn over the nodes), among the cores allowed
+///    to the process (Linux only);
+///  - grainsize n: number of events per task of the tasking run manager.
+
+class WorkerInitialization : public G4UserWorkerInitialization
+{
+  public:
+    WorkerInitialization();
+    ~WorkerInitialization() override;
+
+    void WorkerStart() const override;
+
+    void SetAffinity(const G4String& affinity) { fAffinity = affinity; }
+    void SetGrainsize(G4int grainsize);
+
+  private:
+    // The cores allowed to the process, grouped by NUMA node
+    std::vector<std::vector<G4int>> GetNodesCores() const;
+
+    G4GenericMessenger* fMessenger = nullptr;
+    G4String fAffinity = "none";
+};
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
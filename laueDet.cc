@@ -30,14 +30,22 @@
 
 #include "DetectorConstruction.hh"
 #include "ActionInitialization.hh"
+#include "EventTracer.hh"
+#include "LaueLens.hh"
+#include "Logger.hh"
+#include "PhysicsList.hh"
+#include "WorkerInitialization.hh"
 
 #include "G4RunManagerFactory.hh"
+#include "G4Threading.hh"
 #include "G4UImanager.hh"
-#include "FTFP_BERT.hh"
-#include "G4EmLivermorePolarizedPhysics.hh"
 
+// The batch only build (WITH_GEANT4_UIVIS=OFF) has no UI session
+// and no visualization
+#ifdef LAUE_WITH_UIVIS
 #include "G4VisExecutive.hh"
 #include "G4UIExecutive.hh"
+#endif
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
@@ -45,10 +53,19 @@ namespace {
   void PrintUsage() {
     G4cerr << "USAGE" << G4endl;
     G4cerr << "Batch mode" << G4endl;
-    G4cerr << "laueDet -m macro [-t nThreads]" << G4endl;
+    G4cerr << "laueDet -m macro [-v] [-t nThreads] [-r runManager] [-g grainsize] [-a affinity]"
+           << " [-p emPhysics]" << G4endl;
     G4cerr << "Interactive mode" << G4endl;
-    G4cerr << "laueDet [-t nThreads]" << G4endl;
+    G4cerr << "laueDet [-t nThreads] [-r runManager] [-g grainsize] [-a affinity]"
+           << " [-p emPhysics]" << G4endl;
     G4cerr << "note: -t option is used only in multi-threaded mode." << G4endl;
+    G4cerr << "  -v: initialise the visualization in batch mode (file drivers)" << G4endl;
+    G4cerr << "  -r serial|mt|tasking|tbb: run manager type (default: Geant4 default," << G4endl;
+    G4cerr << "     or the G4RUN_MANAGER_TYPE environment variable)" << G4endl;
+    G4cerr << "  -g grainsize: number of events per task (tasking, tbb)" << G4endl;
+    G4cerr << "  -a none|core|numa: pin the worker threads to cores or NUMA nodes" << G4endl;
+    G4cerr << "  -p " << ED::PhysicsList::GetEmNames() << ":" << G4endl;
+    G4cerr << "     electromagnetic physics (default: livermorePolarized)" << G4endl;
     G4cerr << G4endl;
   }
 }
@@ -57,31 +74,102 @@ int main(int argc,char** argv)
 {
   G4String macro;
   G4String session;
-  G4String physicsListName;
+  G4String physicsListName = "livermorePolarized";
   G4String gdmlFileName;
   G4int nofThreads = 1;
+  auto runManagerType = G4RunManagerType::Default;
+  G4int grainsize = 0;
+  G4String affinity = "none";
+  G4bool batchVis = false;
   for ( G4int i=1; i<argc; i=i+2 ) {
+    // The only option without value
+    if ( G4String(argv[i]) == "-v" ) {
+      batchVis = true;
+      --i;
+      continue;
+    }
+    if ( i+1 >= argc ) {
+      PrintUsage();
+      return 1;
+    }
     if      ( G4String(argv[i]) == "-m" ) macro = argv[i+1];
     else if ( G4String(argv[i]) == "-t" ) {
       nofThreads = G4UIcommand::ConvertToInt(argv[i+1]);
     }
+    else if ( G4String(argv[i]) == "-r" ) {
+      G4String name = argv[i+1];
+      if      ( name == "serial" )  runManagerType = G4RunManagerType::Serial;
+      else if ( name == "mt" )      runManagerType = G4RunManagerType::MT;
+      else if ( name == "tasking" ) runManagerType = G4RunManagerType::Tasking;
+      else if ( name == "tbb" )     runManagerType = G4RunManagerType::TBB;
+      else {
+        PrintUsage();
+        return 1;
+      }
+    }
+    else if ( G4String(argv[i]) == "-g" ) {
+      grainsize = G4UIcommand::ConvertToInt(argv[i+1]);
+    }
+    else if ( G4String(argv[i]) == "-p" ) {
+      physicsListName = argv[i+1];
+      if ( ! ED::PhysicsList::IsEmName(physicsListName) ) {
+        PrintUsage();
+        return 1;
+      }
+    }
+    else if ( G4String(argv[i]) == "-a" ) {
+      affinity = argv[i+1];
+      if ( affinity != "none" && affinity != "core" && affinity != "numa" ) {
+        PrintUsage();
+        return 1;
+      }
+    }
     else {
       PrintUsage();
       return 1;
     }
   }
 
+#ifndef LAUE_WITH_UIVIS
+  if ( ! macro.size() || batchVis ) {
+    G4cerr << "laueDet was built without UI and visualization "
+           << "(WITH_GEANT4_UIVIS=OFF): use -m macro, without -v" << G4endl;
+    return 1;
+  }
+#endif
+
   // Detect interactive mode (if no arguments) and define UI session
   //
+#ifdef LAUE_WITH_UIVIS
   G4UIExecutive* ui = nullptr;
   if ( ! macro.size() ) {
     ui = new G4UIExecutive(argc, argv);
   }
+#endif
 
-// Construct the run manager
-  auto* runManager = G4RunManagerFactory::CreateRunManager(G4RunManagerType::Default);
+  // Construct the logger, the tracer and the lens model
+  // (before the macros which set them)
+  auto logger = new ED::Logger();
+  auto tracer = new ED::EventTracer();
+  auto lens = new ED::LaueLens();
+
+// Construct the run manager of the selected type
+  auto* runManager = G4RunManagerFactory::CreateRunManager(runManagerType);
   runManager->SetNumberOfThreads(nofThreads);
 
+  // Worker threads setup (also with the /threads/ commands),
+  // only with a multi-threaded run manager
+  if ( G4Threading::IsMultithreadedApplication() ) {
+    auto workerInitialization = new ED::WorkerInitialization();
+    workerInitialization->SetAffinity(affinity);
+    if ( grainsize > 0 ) workerInitialization->SetGrainsize(grainsize);
+    runManager->SetUserInitialization(workerInitialization);
+  }
+  else if ( affinity != "none" || grainsize > 0 ) {
+    G4cerr << "Warning: -a and -g are ignored with the serial run manager"
+           << G4endl;
+  }
+
 // Get the pointer to the User Interface manager
   auto UImanager = G4UImanager::GetUIpointer();
   
@@ -92,43 +180,53 @@ int main(int argc,char** argv)
   runManager->SetUserInitialization(new ED::DetectorConstruction());
   UImanager->ApplyCommand("/control/execute detector.mac");
 
-  // Physics list
-  //auto physicsList = new FTFP_BERT;
-  G4VModularPhysicsList* physicsList = new G4VModularPhysicsList();
-  physicsList->RegisterPhysics(new G4EmLivermorePolarizedPhysics());
-  physicsList->SetVerboseLevel(1);
-  runManager->SetUserInitialization(physicsList);
+  // Physics list (-p, or /physics/em before /run/initialize)
+  runManager->SetUserInitialization(new ED::PhysicsList(physicsListName));
 
   // User action initialization
   runManager->SetUserInitialization(new ED::ActionInitialization());
 
-  // Initialize visualization
+  // Initialize visualization, only in interactive mode or with -v:
+  // the batch jobs do not construct any UI or visualization object
   //
-  auto visManager = new G4VisExecutive;
-  // G4VisExecutive can take a verbosity argument - see /vis/verbose guidance.
-  // auto visManager = new G4VisExecutive("Quiet");
-  visManager->Initialize();
+#ifdef LAUE_WITH_UIVIS
+  G4VisManager* visManager = nullptr;
+  if ( ui || batchVis ) {
+    visManager = new G4VisExecutive;
+    // G4VisExecutive can take a verbosity argument - see /vis/verbose guidance.
+    // visManager = new G4VisExecutive("Quiet");
+    visManager->Initialize();
+  }
+
+#endif
 
-  if ( ! ui ) {
+  if ( macro.size() ) {
     // batch mode
     G4String command = "/control/execute ";
     G4String fileName = macro; //argv[1];
     UImanager->ApplyCommand(command+fileName);
   }
+#ifdef LAUE_WITH_UIVIS
   else {
     // interactive mode : define UI session
     UImanager->ApplyCommand("/control/execute init_vis.mac");
     ui->SessionStart();
     delete ui;
   }
+#endif
 
   // Job termination
   // Free the store: user actions, physics_list and detector_description are
   // owned and deleted by the run manager, so they should not be deleted
   // in the main() program !
 
+#ifdef LAUE_WITH_UIVIS
   delete visManager;
+#endif
   delete runManager;
+  delete lens;
+  delete tracer;
+  delete logger;
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo.....
@@ -0,0 +1,114 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+// $Id$
+//
+/// \file AcceptanceFilter.cc
+/// \brief Implementation of the AcceptanceFilter class
+
+#include "AcceptanceFilter.hh"
+
+#include "G4Event.hh"
+#include "G4LogicalVolume.hh"
+#include "G4PrimaryParticle.hh"
+#include "G4PrimaryVertex.hh"
+#include "G4TransportationManager.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4VSolid.hh"
+#include "G4Navigator.hh"
+
+namespace
+{
+
+G4bool IsSensitive(const G4LogicalVolume* volume)
+{
+  if ( volume->GetSensitiveDetector() ) return true;
+  for ( std::size_t i=0; i<volume->GetNoDaughters(); ++i ) {
+    if ( IsSensitive(volume->GetDaughter(i)->GetLogicalVolume()) ) return true;
+  }
+  return false;
+}
+
+}
+
+namespace ED
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void AcceptanceFilter::FindEnvelopes()
+{
+  fInitialized = true;
+  auto world = G4TransportationManager::GetTransportationManager()
+                 ->GetNavigatorForTracking()->GetWorldVolume();
+  if ( ! world ) return;
+
+  auto worldLV = world->GetLogicalVolume();
+  for ( std::size_t i=0; i<worldLV->GetNoDaughters(); ++i ) {
+    auto daughter = worldLV->GetDaughter(i);
+    if ( ! IsSensitive(daughter->GetLogicalVolume()) ) continue;
+    G4AffineTransform toWorld(daughter->GetRotation(), daughter->GetTranslation());
+    fEnvelopes.push_back({ daughter->GetLogicalVolume()->GetSolid(), toWorld.Inverse() });
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool AcceptanceFilter::IsAccepted(const G4ThreeVector& position,
+                                    const G4ThreeVector& direction)
+{
+  if ( ! fInitialized ) FindEnvelopes();
+
+  for ( const auto& envelope : fEnvelopes ) {
+    // On the surface, the path enters the envelope if DistanceToIn is 0
+    // (and leaves it otherwise)
+    auto localPosition = envelope.toLocal.TransformPoint(position);
+    if ( envelope.solid->Inside(localPosition) == kInside ) return true;
+    auto localDirection = envelope.toLocal.TransformAxis(direction);
+    if ( envelope.solid->DistanceToIn(localPosition, localDirection) < kInfinity ) {
+      return true;
+    }
+  }
+  return false;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool AcceptanceFilter::IsAccepted(const G4Event* event)
+{
+  for ( G4int i=0; i<event->GetNumberOfPrimaryVertex(); ++i ) {
+    auto vertex = event->GetPrimaryVertex(i);
+    for ( auto particle = vertex->GetPrimary(); particle; particle = particle->GetNext() ) {
+      if ( IsAccepted(vertex->GetPosition(), particle->GetMomentumDirection()) ) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
@@ -32,6 +32,8 @@
 #include "PrimaryGeneratorAction.hh"
 #include "RunAction.hh"
 #include "EventAction.hh"
+#include "SteppingAction.hh"
+#include "StackingAction.hh"
 
 namespace ED
 {
@@ -50,7 +52,11 @@ ActionInitialization::~ActionInitialization()
 
 void ActionInitialization::BuildForMaster() const
 {
-  SetUserAction(new RunAction);
+  // The master books the same Events ntuple as the workers, which is
+  // needed by the ntuple merging; its event action only provides the
+  // vector columns (as in example B5, it is not registered)
+  auto eventAction = new EventAction;
+  SetUserAction(new RunAction(eventAction));
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -58,8 +64,16 @@ void ActionInitialization::BuildForMaster() const
 void ActionInitialization::Build() const
 {
   SetUserAction(new PrimaryGeneratorAction);
-  SetUserAction(new RunAction);
-  SetUserAction(new EventAction);
+
+  auto eventAction = new EventAction;
+  SetUserAction(eventAction);
+  SetUserAction(new RunAction(eventAction));
+
+  // Escaping particles killing and steps timing (/profile/enable)
+  SetUserAction(new SteppingAction);
+
+  // Local deposit of the short range electrons (/stacking/localDeposit)
+  SetUserAction(new StackingAction);
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,174 @@
+/// \file ColumnarWriter.cc
+/// \brief Implementation of the ColumnarWriter class
+
+#include "ColumnarWriter.hh"
+
+#include <algorithm>
+#include <cstring>
+
+namespace ED
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+ColumnarWriter::ColumnarWriter(const std::string& fileName,
+                               const std::vector<lcol::ColumnDescriptor>& columns,
+                               std::size_t chunkSize)
+ : fFileName(fileName),
+   fColumns(columns),
+   fChunkSize(chunkSize > 0 ? chunkSize : 1),
+   fBuffers(columns.size())
+{
+  // Layout of a row: the values at 8 bytes aligned offsets
+  for ( std::size_t i=0; i<fColumns.size(); ++i ) {
+    fRowOffsets.push_back(8*i);
+  }
+  fRow.assign(8*fColumns.size(), 0);
+  for ( std::size_t i=0; i<fColumns.size(); ++i ) {
+    fBuffers[i].reserve(fChunkSize*fColumns[i].width);
+  }
+
+  fFile = std::fopen(fFileName.c_str(), "wb");
+  if ( fFile == nullptr ) return;
+
+  // The header is rewritten with the final offsets on Close()
+  lcol::FileHeader header {};
+  std::memcpy(header.magic, lcol::kMagic, sizeof(header.magic));
+  header.version = lcol::kVersion;
+  header.nofColumns = fColumns.size();
+  Write(&header, sizeof(header));
+  Write(fColumns.data(), fColumns.size()*sizeof(lcol::ColumnDescriptor));
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+ColumnarWriter::~ColumnarWriter()
+{
+  Close();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ColumnarWriter::SetMetadata(const std::string& key, const std::string& value)
+{
+  for ( auto& entry : fMetadata ) {
+    if ( entry.first == key ) {
+      entry.second = value;
+      return;
+    }
+  }
+  fMetadata.emplace_back(key, value);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ColumnarWriter::AddRow()
+{
+  for ( std::size_t i=0; i<fColumns.size(); ++i ) {
+    auto value = &fRow[fRowOffsets[i]];
+    fBuffers[i].insert(fBuffers[i].end(), value, value + fColumns[i].width);
+  }
+
+  // Column 0 is the event ID
+  int64_t eventID = 0;
+  if ( fColumns[0].type == lcol::ColumnType::kInt32 ) {
+    int32_t value;
+    std::memcpy(&value, &fRow[0], sizeof(value));
+    eventID = value;
+  }
+  else if ( fColumns[0].type == lcol::ColumnType::kInt64 ) {
+    std::memcpy(&eventID, &fRow[0], sizeof(eventID));
+  }
+  if ( fNofBufferedRows == 0 ) {
+    fMinEventID = eventID;
+    fMaxEventID = eventID;
+  }
+  else {
+    fMinEventID = std::min(fMinEventID, eventID);
+    fMaxEventID = std::max(fMaxEventID, eventID);
+  }
+
+  if ( ++fNofBufferedRows == fChunkSize ) FlushChunk();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ColumnarWriter::AddRow(const std::vector<const void*>& values)
+{
+  assert(values.size() == fColumns.size());
+  for ( std::size_t i=0; i<fColumns.size(); ++i ) {
+    std::memcpy(&fRow[fRowOffsets[i]], values[i], fColumns[i].width);
+  }
+  AddRow();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ColumnarWriter::FlushChunk()
+{
+  if ( fNofBufferedRows == 0 || fFile == nullptr ) return;
+
+  lcol::ChunkIndexEntry entry { fOffset, fNofBufferedRows,
+                                fMinEventID, fMaxEventID };
+  fIndex.push_back(entry);
+
+  static const char padding[8] = {};
+  for ( auto& buffer : fBuffers ) {
+    Write(buffer.data(), buffer.size());
+    Write(padding, lcol::Padded(buffer.size()) - buffer.size());
+    buffer.clear();
+  }
+  fNofRows += fNofBufferedRows;
+  fNofBufferedRows = 0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ColumnarWriter::Write(const void* data, std::size_t size)
+{
+  if ( size == 0 ) return;
+  fGood = fGood && std::fwrite(data, 1, size, fFile) == size;
+  fOffset += size;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+bool ColumnarWriter::Close()
+{
+  if ( fFile == nullptr ) return false;
+
+  FlushChunk();
+
+  // Metadata block
+  std::string metadata;
+  for ( const auto& entry : fMetadata ) {
+    metadata += entry.first + "=" + entry.second + "\n";
+  }
+  lcol::FileHeader header {};
+  std::memcpy(header.magic, lcol::kMagic, sizeof(header.magic));
+  header.version = lcol::kVersion;
+  header.nofColumns = fColumns.size();
+  header.nofRows = fNofRows;
+  header.nofChunks = fIndex.size();
+  header.metadataOffset = fOffset;
+  header.metadataSize = metadata.size();
+  static const char padding[8] = {};
+  Write(metadata.data(), metadata.size());
+  Write(padding, lcol::Padded(metadata.size()) - metadata.size());
+
+  // Chunk index
+  header.indexOffset = fOffset;
+  Write(fIndex.data(), fIndex.size()*sizeof(lcol::ChunkIndexEntry));
+
+  // Final header
+  fGood = fGood && std::fseek(fFile, 0, SEEK_SET) == 0;
+  fGood = fGood && std::fwrite(&header, 1, sizeof(header), fFile) == sizeof(header);
+  fGood = (std::fclose(fFile) == 0) && fGood;
+  fFile = nullptr;
+
+  return fGood;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
@@ -30,6 +30,7 @@
 
 #include "DetectorConstruction.hh"
 #include "EmCalorimeterSD.hh"
+#include "PixelParameterisation.hh"
 
 #include "G4NistManager.hh"
 #include "G4SDManager.hh"
@@ -37,14 +38,26 @@
 #include "G4Box.hh"
 #include "G4Tubs.hh"
 #include "G4LogicalVolume.hh"
+#include "G4LogicalVolumeStore.hh"
+#include "G4ProductionCuts.hh"
+#include "G4Region.hh"
+#include "G4RegionStore.hh"
 #include "G4PVPlacement.hh"
+#include "G4PVParameterised.hh"
 #include "G4RotationMatrix.hh"
+#include "G4Transform3D.hh"
 #include "G4SystemOfUnits.hh"
 #include "G4GenericMessenger.hh"
+#include "G4Timer.hh"
 
 #include "G4GDMLParser.hh"
 
-#include "GetGlobalPosition.hh"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <set>
+#include <sstream>
 
 namespace ED
 {
@@ -52,9 +65,41 @@ namespace ED
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 DetectorConstruction::DetectorConstruction()
-{ 
+ : fPitchA(10.*cm),
+   fPitchB(10.*cm),
+   fDetectorCut(50.*um)
+{
   fMessenger = new G4GenericMessenger(this, "/detector/", "Detector contruction");
   fMessenger->DeclareProperty("detAsizeZ", detAsizeZ, "Thickness of the detector A");
+  fMessenger->DeclareProperty("nPixelsA", fNofPixelsA,
+                              "Number of pixels per side of the detector A");
+  fMessenger->DeclarePropertyWithUnit("pitchA", "cm", fPitchA,
+                                      "Pixel pitch of the detector A");
+  fMessenger->DeclareProperty("nPixelsB", fNofPixelsB,
+                              "Number of pixels per side of the detector B");
+  fMessenger->DeclarePropertyWithUnit("pitchB", "cm", fPitchB,
+                                      "Pixel pitch of the detector B");
+  fMessenger->DeclareProperty("readoutA", fReadoutA,
+    "Pixels of the detector A: one volume per pixel (volume)\n"
+    "or computed from the hit position in a single volume (virtual)")
+    .SetCandidates("volume virtual");
+  fMessenger->DeclareProperty("readoutB", fReadoutB,
+    "Pixels of the detector B: volume or virtual (see readoutA)")
+    .SetCandidates("volume virtual");
+  fMessenger->DeclareProperty("readoutC", fReadoutC,
+    "Segments of the detector C: volume or virtual (see readoutA)")
+    .SetCandidates("volume virtual");
+  fMessenger->DeclareProperty("checkOverlaps", fCheckOverlaps,
+    "Volumes overlaps check: off, full, or cached (the verdict is\n"
+    "stored in overlaps.cache for each geometry and not recomputed)")
+    .SetCandidates("off full cached");
+  fMessenger->DeclareProperty("gdmlCache", fGDMLCacheDir,
+    "Directory of the GDML geometry cache (empty: no cache);\n"
+    "a geometry is built once and then read from its GDML file");
+  fMessenger->DeclareMethodWithUnit("detectorCut", "mm", &DetectorConstruction::SetDetectorCut,
+    "Production cut of the FocalPlane region (the detectors A, B and C);\n"
+    "the world has the default cut of the physics list (/run/setCut)")
+    .command->SetToBeBroadcasted(false);
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -64,8 +109,39 @@ DetectorConstruction::~DetectorConstruction()
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
+G4int DetectorConstruction::GetChannelStride() const
+{
+  // Smallest power of 10 (at least 1000) above the number of channels
+  // of each detector, so that the channel ranges do not overlap
+  auto maxCount = std::max({ fNofPixelsA*fNofPixelsA, fNofPixelsB*fNofPixelsB,
+                             fNofSegmentsC });
+  G4int stride = 1000;
+  while ( stride < maxCount ) stride *= 10;
+  return stride;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
 G4VPhysicalVolume* DetectorConstruction::Construct()
 {
+  G4Timer timer;
+  timer.Start();
+
+  // Load the geometry from the GDML cache if it has already been built
+  // with the same parameters
+  if ( ! fGDMLCacheDir.empty() ) {
+    auto cachedWorldPV = ReadGeometryCache();
+    if ( cachedWorldPV ) {
+      timer.Stop();
+      G4cout << ">>> Geometry loaded from the GDML cache in "
+             << timer.GetRealElapsed() << " s" << G4endl;
+      BuildGeometryIndex(cachedWorldPV);
+      ConstructRegion();
+      CheckOverlaps(cachedWorldPV);
+      return cachedWorldPV;
+    }
+  }
+
   // --- MATERIALS DEFINITION ---
   // Get nist material manager
   auto nistManager = G4NistManager::Instance();
@@ -99,19 +175,10 @@ G4VPhysicalVolume* DetectorConstruction::Construct()
   // Print all materials
   // G4cout << *(G4Material::GetMaterialTable()) << G4endl;
 
-  // Define the output file for the lookup table
-  G4String filename = "lookup_table.txt";
-  std::ofstream lookupTable(filename);
-  // Check if the file was successfully opened
-  if (!lookupTable.is_open()) {
-        G4cerr << "Error: Could not open the file for writing!" << G4endl;
-  }
-  lookupTable << "# Look up table (det,x,y,z) x,y,z in cm" << G4endl;
-  lookupTable << "# detID  x(cm) y(cm) z(cm)" << G4endl;
-
   // --- VOLUMES DEFINITIONS ---
-  // Option to switch on/off checking of volumes overlaps
-  G4bool checkOverlaps = true;
+  // The volumes overlaps are checked after the construction
+  // according to the /detector/checkOverlaps mode (see CheckOverlaps)
+  G4bool checkOverlaps = false;
 
   //
   // World
@@ -136,13 +203,14 @@ G4VPhysicalVolume* DetectorConstruction::Construct()
 
 
   // detector A
-  G4double detAx = 0.5*m; // half size
-  G4double detAy = 0.5*m;
+  // pixels array built with a parameterised volume
+  G4double detAx = 0.5*fNofPixelsA*fPitchA; // half size
+  G4double detAy = 0.5*fNofPixelsA*fPitchA;
   G4double detAz = detAsizeZ/2.*cm; //0.5*cm;
   auto detectorAS = new G4Box("detectorAS", detAx, detAy, detAz);
   auto detectorALV = new G4LogicalVolume(detectorAS, silicon, "detectorA");
 
-  auto detectorAPV = new G4PVPlacement(0,
+  new G4PVPlacement(0,
                     G4ThreeVector(0, 0, -20.*cm),
                     detectorALV,          //its logical volume
                     "detectorA",            //its name
@@ -150,50 +218,36 @@ G4VPhysicalVolume* DetectorConstruction::Construct()
                     false,                 //no boolean operation
                     0,                     //copy number
                     checkOverlaps);        //overlaps checking
-  G4ThreeVector detectorPositionLevel1 = GetGlobalPosition(detectorAPV);
-  G4cout << "Detector position level 1: " << detectorPositionLevel1/cm << " cm" << G4endl;
 
-  hx = detAx/10.;
-  hy = detAy/10.;
+  auto channelsA = GetChannelsA();
+  hx = 0.5*fPitchA;
+  hy = 0.5*fPitchA;
   hz = detAz;
   auto detectorUnitAS = new G4Box("detectorUnitAS", hx, hy, hz);
   auto detectorUnitALV = new G4LogicalVolume(detectorUnitAS, silicon, "detectorUnitA");
 
-  G4double xPos, yPos, zPos;
-  for (G4int i=0; i<10; ++i) {
-    for (G4int j=0; j<10; ++j) {
-      xPos = -0.9*detAx + 2*i*hx;
-      yPos = -0.9*detAy + 2*j*hy;
-      zPos = 0.;
-      auto detectorUnitAPV = new G4PVPlacement(0,
-                    G4ThreeVector(xPos, yPos, zPos),
-                    //G4ThreeVector(0, 0, 0),
-                    detectorUnitALV,          //its logical volume
-                    "detectorUnitA",            //its name
-                    detectorALV,               //its mother  volume
-                    false,                 //no boolean operation
-                    1000 + i*10+j,                     //copy number
-                    checkOverlaps);        //overlaps checking
-      G4ThreeVector detectorPositionLevel2 = GetGlobalPosition(detectorUnitAPV);
-      G4ThreeVector detectorPos = detectorPositionLevel1 + detectorPositionLevel2;
-      // Debug
-      G4cout << "Detector position (level 1+2): " << detectorPos/cm << " cm" << G4endl;
-      // Print out the detector number and the position relative to worldLV
-      G4double detectorPosX = detectorPos[0];
-      G4double detectorPosY = detectorPos[1];
-      G4double detectorPosZ = detectorPos[2];
-      lookupTable << 1000 + i*10+j << "," << detectorPosX/cm << "," << detectorPosY/cm << "," << detectorPosZ/cm << G4endl;
-    }
+  // with the virtual readout, the pixels are not built
+  if ( fReadoutA == "volume" ) {
+    auto pixelsA = new PixelParameterisation(fNofPixelsA, fPitchA);
+    new G4PVParameterised("detectorUnitA",       //its name
+                      detectorUnitALV,          //its logical volume
+                      detectorALV,              //its mother  volume
+                      kUndefined,               //3D voxelisation
+                      channelsA.count,          //number of pixels
+                      pixelsA,                  //parameterisation
+                      checkOverlaps);           //overlaps checking
   }
 
+
   // detector B
-  G4double detBx = 0.5*m; // half size
-  G4double detBy = 0.5*m;
+  // pixels array built with a parameterised volume
+  G4double detBx = 0.5*fNofPixelsB*fPitchB; // half size
+  G4double detBy = 0.5*fNofPixelsB*fPitchB;
   G4double detBz = 1.*cm;
   auto detectorBS = new G4Box("detectorBS", detBx, detBy, detBz);
   auto detectorBLV = new G4LogicalVolume(detectorBS, CZT, "detectorB");
 
-  auto detectorBPV =new G4PVPlacement(0,
+  new G4PVPlacement(0,
                     G4ThreeVector(0, 0, +20.*cm),
                     detectorBLV,          //its logical volume
                     "detectorB",            //its name
@@ -201,43 +255,28 @@ G4VPhysicalVolume* DetectorConstruction::Construct()
                     false,                 //no boolean operation
                     0,                     //copy number
                     checkOverlaps);        //overlaps checking
-  detectorPositionLevel1 = GetGlobalPosition(detectorBPV);
-  G4cout << "Detector position level 1: " << detectorPositionLevel1/cm << " cm" << G4endl;
 
-  hx = detBx/10.;
-  hy = detBy/10.;
+  auto channelsB = GetChannelsB();
+  hx = 0.5*fPitchB;
+  hy = 0.5*fPitchB;
   hz = detBz;
   auto detectorUnitBS = new G4Box("detectorUnitBS", hx, hy, hz);
   auto detectorUnitBLV = new G4LogicalVolume(detectorUnitBS, CZT, "detectorUnitB");
 
-  for (G4int i=0; i<10; ++i) {
-    for (G4int j=0; j<10; ++j) {
-      xPos = -0.9*detBx + 2*i*hx;
-      yPos = -0.9*detBy + 2*j*hy;
-      zPos = 0.;
-      auto detectorUnitBPV = new G4PVPlacement(0,
-                    G4ThreeVector(xPos, yPos, zPos),
-                    //G4ThreeVector(0, 0, 0),
-                    detectorUnitBLV,          //its logical volume
-                    "detectorUnitB",            //its name
-                    detectorBLV,               //its mother  volume
-                    false,                 //no boolean operation
-                    2000 + i*10+j,                     //copy number
-                    checkOverlaps);        //overlaps checking
-      G4ThreeVector detectorPositionLevel2 = GetGlobalPosition(detectorUnitBPV);
-      G4ThreeVector detectorPos = detectorPositionLevel1 + detectorPositionLevel2;
-      // Debug
-      G4cout << "Detector position (level 1+2): " << detectorPos/cm << " cm" << G4endl;
-      // Print out the detector number and the position relative to worldLV
-      G4double detectorPosX = detectorPos[0];
-      G4double detectorPosY = detectorPos[1];
-      G4double detectorPosZ = detectorPos[2];
-      lookupTable << 2000 + i*10+j << "," << detectorPosX/cm << "," << detectorPosY/cm << "," << detectorPosZ/cm << G4endl;
-    }
-
+  // with the virtual readout, the pixels are not built
+  if ( fReadoutB == "volume" ) {
+    auto pixelsB = new PixelParameterisation(fNofPixelsB, fPitchB);
+    new G4PVParameterised("detectorUnitB",       //its name
+                      detectorUnitBLV,          //its logical volume
+                      detectorBLV,              //its mother  volume
+                      kUndefined,               //3D voxelisation
+                      channelsB.count,          //number of pixels
+                      pixelsB,                  //parameterisation
+                      checkOverlaps);           //overlaps checking
   }
 
 
+
   // Detector C
   G4double rmin = 95.*cm;
   G4double rmax = 100.*cm;
@@ -256,36 +295,41 @@ G4VPhysicalVolume* DetectorConstruction::Construct()
                     0,                     //copy number
                     checkOverlaps);        //overlaps checking
 
+  auto channelsC = GetChannelsC();
   rmin = 95.*cm;
   rmax = 100.*cm;
   hz = 30.*cm;
   phimin = 0.*deg;
-  dphi = 3.6*deg;
+  dphi = 360.*deg/fNofSegmentsC;
   auto detectorUnitCS = new G4Tubs("detectorUnitC", rmin, rmax, hz, phimin, dphi);
   auto detectorUnitCLV = new G4LogicalVolume(detectorUnitCS, CZT, "detectorUnitC");
 
-  for (G4int i=0; i<100; ++i) { 
-    G4ThreeVector detectorPos(100.0*cm, 0.0, 0.0);
-    G4RotationMatrix* rotationMatrix = new G4RotationMatrix;
-    rotationMatrix->rotateZ(i*dphi);
-    detectorPos[0] = 100.*cm * std::cos(dphi/2. + i*dphi);
-    detectorPos[1] = 100.*cm * std::sin(dphi/2. + i*dphi);
-    new G4PVPlacement(rotationMatrix,
-                    G4ThreeVector(),       //at (0,0,0)
+  // with the virtual readout, the segments are not built
+  // (the segment i covers phi from i*dphi to (i+1)*dphi, as in the
+  // virtual readout)
+  for (G4int i=0; fReadoutC == "volume" && i<fNofSegmentsC; ++i) {
+    G4RotationMatrix rotationMatrix;
+    rotationMatrix.rotateZ(i*dphi);
+    new G4PVPlacement(G4Transform3D(rotationMatrix, G4ThreeVector()),
                     detectorUnitCLV,                //its logical volume
                     "detectorUnitC",                //its name
                     detectorCLV,               //its mother  volume
                     false,                 //no boolean operation
-                    3000+i,                     //copy number
+                    channelsC.first + i,        //copy number
                     checkOverlaps);        //overlaps checking
-    // Debug
-    G4cout << "Detector position (level 1+2): " << detectorPos/cm << " cm" << G4endl;
-    lookupTable << 3000 + i << "," << detectorPos[0]/cm << "," << detectorPos[1]/cm << "," << detectorPos[2]/cm << G4endl;
   }
-  
-  // close the lookup table file
-  lookupTable.close();
-  G4cout << ">>> Lookup table file " << filename << " written succesfully" << G4endl;
+
+  timer.Stop();
+  G4cout << ">>> Geometry constructed in " << timer.GetRealElapsed() << " s ("
+         << channelsA.count + channelsB.count + channelsC.count << " detectors)" << G4endl;
+
+  BuildGeometryIndex(worldPV);
+  ConstructRegion();
+  CheckOverlaps(worldPV);
+
+  if ( ! fGDMLCacheDir.empty() ) {
+    WriteGeometryCache(worldPV);
+  }
 
   //always return the physical World
   //
@@ -294,22 +338,229 @@ G4VPhysicalVolume* DetectorConstruction::Construct()
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
+G4String DetectorConstruction::GetGeometryHash() const
+{
+  // All the parameters which define the geometry; kGeometryVersion
+  // must be increased when the construction code changes
+  const G4int kGeometryVersion = 2;
+  std::ostringstream parameters;
+  parameters << std::setprecision(17)
+             << kGeometryVersion << ' ' << detAsizeZ << ' '
+             << fNofPixelsA << ' ' << fPitchA << ' ' << fReadoutA << ' '
+             << fNofPixelsB << ' ' << fPitchB << ' ' << fReadoutB << ' '
+             << fNofSegmentsC << ' ' << fReadoutC;
+
+  // 64-bit FNV-1a hash
+  uint64_t hash = 14695981039346656037ull;
+  for ( auto c : parameters.str() ) {
+    hash ^= (unsigned char)c;
+    hash *= 1099511628211ull;
+  }
+  std::ostringstream hex;
+  hex << std::hex << std::setw(16) << std::setfill('0') << hash;
+  return hex.str();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DetectorConstruction::CheckOverlaps(G4VPhysicalVolume* worldPV) const
+{
+  if ( fCheckOverlaps == "off" ) return;
+
+  // In cached mode, the verdict of a previous check of the same
+  // geometry is read from the cache file
+  const G4String cacheFileName = "overlaps.cache";
+  auto hash = GetGeometryHash();
+  if ( fCheckOverlaps == "cached" ) {
+    std::ifstream cache(cacheFileName);
+    G4String cachedHash;
+    G4int cachedOverlaps;
+    while ( cache >> cachedHash >> cachedOverlaps ) {
+      if ( cachedHash != hash ) continue;
+      G4cout << ">>> Overlaps check skipped, geometry " << hash
+             << " in " << cacheFileName << ": "
+             << ( cachedOverlaps ? "overlaps found" : "no overlaps" ) << G4endl;
+      if ( cachedOverlaps ) {
+        G4Exception("DetectorConstruction::CheckOverlaps()", "laueDet0007",
+                    JustWarning, "The geometry has overlapping volumes (cached).");
+      }
+      return;
+    }
+  }
+
+  // Check all the daughters of each logical volume once
+  G4Timer timer;
+  timer.Start();
+  G4bool overlaps = false;
+  std::set<const G4LogicalVolume*> checked;
+  std::vector<const G4LogicalVolume*> volumes = { worldPV->GetLogicalVolume() };
+  while ( ! volumes.empty() ) {
+    auto volume = volumes.back();
+    volumes.pop_back();
+    if ( ! checked.insert(volume).second ) continue;
+    for ( std::size_t i=0; i<volume->GetNoDaughters(); ++i ) {
+      auto daughter = volume->GetDaughter(i);
+      overlaps = daughter->CheckOverlaps() || overlaps;
+      volumes.push_back(daughter->GetLogicalVolume());
+    }
+  }
+  timer.Stop();
+  G4cout << ">>> Overlaps checked in " << timer.GetRealElapsed() << " s: "
+         << ( overlaps ? "overlaps found" : "no overlaps" ) << G4endl;
+
+  if ( fCheckOverlaps == "cached" ) {
+    std::ofstream cache(cacheFileName, std::ios::app);
+    cache << hash << " " << overlaps << std::endl;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DetectorConstruction::BuildGeometryIndex(G4VPhysicalVolume* worldPV)
+{
+  // The channels of each detector, read out from the pixel volumes
+  // or from the detector volume (virtual readout)
+  fGeometryIndex.Clear();
+  if ( fReadoutA == "volume" ) {
+    fGeometryIndex.AddVolumeReadout("detectorUnitA", GetChannelsA());
+  }
+  else {
+    fGeometryIndex.AddGridReadout("detectorA", GetChannelsA(), fNofPixelsA, fPitchA);
+  }
+  if ( fReadoutB == "volume" ) {
+    fGeometryIndex.AddVolumeReadout("detectorUnitB", GetChannelsB());
+  }
+  else {
+    fGeometryIndex.AddGridReadout("detectorB", GetChannelsB(), fNofPixelsB, fPitchB);
+  }
+  if ( fReadoutC == "volume" ) {
+    fGeometryIndex.AddVolumeReadout("detectorUnitC", GetChannelsC());
+  }
+  else {
+    fGeometryIndex.AddPhiReadout("detectorC", GetChannelsC(), fNofSegmentsC);
+  }
+  fGeometryIndex.Build(worldPV);
+
+  // The lookup tables for the reconstruction
+  try {
+    fGeometryIndex.GetTable().WriteCsv("lookup_table.txt");
+    fGeometryIndex.GetTable().Write("lookup_table.bin");
+  }
+  catch ( const std::exception& error ) {
+    G4Exception("DetectorConstruction::BuildGeometryIndex()", "laueDet0011",
+                JustWarning, error.what());
+    return;
+  }
+  G4cout << ">>> Lookup table files lookup_table.txt and lookup_table.bin written ("
+         << fGeometryIndex.GetTable().GetSize() << " detectors)" << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DetectorConstruction::ConstructRegion()
+{
+  // The detectors are the root volumes of the FocalPlane region,
+  // with tighter production cuts than the vacuum world
+  auto region = G4RegionStore::GetInstance()->GetRegion("FocalPlane", false);
+  if ( ! region ) {
+    region = new G4Region("FocalPlane");
+    region->SetProductionCuts(new G4ProductionCuts());
+  }
+  for ( auto name : { "detectorA", "detectorB", "detectorC" } ) {
+    auto volume = G4LogicalVolumeStore::GetInstance()->GetVolume(name, false);
+    if ( volume && volume->GetRegion() != region ) {
+      region->AddRootLogicalVolume(volume);
+    }
+  }
+  region->GetProductionCuts()->SetProductionCut(fDetectorCut);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DetectorConstruction::SetDetectorCut(G4double cut)
+{
+  fDetectorCut = cut;
+
+  // After the construction, the tables are rebuilt at the next run
+  auto region = G4RegionStore::GetInstance()->GetRegion("FocalPlane", false);
+  if ( region ) region->GetProductionCuts()->SetProductionCut(cut);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4VPhysicalVolume* DetectorConstruction::ReadGeometryCache() const
+{
+  auto gdmlFile = fGDMLCacheDir + "/" + GetGeometryHash() + ".gdml";
+  if ( ! std::filesystem::exists(gdmlFile) ) return nullptr;
+
+  G4GDMLParser parser;
+  parser.Read(gdmlFile, false);
+  G4cout << ">>> Geometry read from " << gdmlFile << G4endl;
+  return parser.GetWorldVolume();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DetectorConstruction::WriteGeometryCache(G4VPhysicalVolume* worldPV) const
+{
+  auto gdmlFile = fGDMLCacheDir + "/" + GetGeometryHash() + ".gdml";
+
+  std::error_code error;
+  std::filesystem::create_directories(fGDMLCacheDir, error);
+  if ( error ) {
+    G4ExceptionDescription msg;
+    msg << "Cannot create " << fGDMLCacheDir << ": " << error.message();
+    G4Exception("DetectorConstruction::WriteGeometryCache()", "laueDet0009",
+                JustWarning, msg);
+    return;
+  }
+  // The GDML parser does not overwrite an existing file
+  std::filesystem::remove(gdmlFile, error);
+
+  G4GDMLParser parser;
+  parser.Write(gdmlFile, worldPV);
+  G4cout << ">>> Geometry written in the GDML cache " << gdmlFile << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
 void DetectorConstruction::ConstructSDandField()
 {
   //
   // Sensitive detectors
   ///
-  auto detectorASD = new EmCalorimeterSD("detectorASD");
+  // Each SD books only the channels of its own detector units.
+  // With the virtual readout, the SD is attached to the whole detector
+  // and computes the pixel from the hit position.
+  auto detectorASD = new EmCalorimeterSD("detectorASD", GetChannelsA());
   G4SDManager::GetSDMpointer()->AddNewDetector(detectorASD);
-  SetSensitiveDetector("detectorUnitA", detectorASD);
+  if ( fReadoutA == "volume" ) {
+    SetSensitiveDetector("detectorUnitA", detectorASD);
+  }
+  else {
+    detectorASD->SetGridReadout(fNofPixelsA, fPitchA);
+    SetSensitiveDetector("detectorA", detectorASD);
+  }
 
-  auto detectorBSD = new EmCalorimeterSD("detectorBSD");
+  auto detectorBSD = new EmCalorimeterSD("detectorBSD", GetChannelsB());
   G4SDManager::GetSDMpointer()->AddNewDetector(detectorBSD);
-  SetSensitiveDetector("detectorUnitB", detectorBSD);
+  if ( fReadoutB == "volume" ) {
+    SetSensitiveDetector("detectorUnitB", detectorBSD);
+  }
+  else {
+    detectorBSD->SetGridReadout(fNofPixelsB, fPitchB);
+    SetSensitiveDetector("detectorB", detectorBSD);
+  }
 
-  auto detectorCSD = new EmCalorimeterSD("detectorCSD");
+  auto detectorCSD = new EmCalorimeterSD("detectorCSD", GetChannelsC());
   G4SDManager::GetSDMpointer()->AddNewDetector(detectorCSD);
-  SetSensitiveDetector("detectorUnitC", detectorCSD);
+  if ( fReadoutC == "volume" ) {
+    SetSensitiveDetector("detectorUnitC", detectorCSD);
+  }
+  else {
+    detectorCSD->SetPhiReadout(fNofSegmentsC);
+    SetSensitiveDetector("detectorC", detectorCSD);
+  }
 }
 
 }
@@ -30,40 +30,40 @@
 //
 
 #include "EmCalorimeterSD.hh"
+#include "Logger.hh"
+#include "ProfileCounters.hh"
 
 #include "G4RunManager.hh"
 #include "G4UImanager.hh"
 #include "G4Event.hh"
-#include "G4AnalysisManager.hh"
 #include "G4HCofThisEvent.hh"
 #include "G4SDManager.hh"
 #include "G4VTouchable.hh"
+#include "G4NavigationHistory.hh"
 #include "G4Step.hh"
+#include "G4Track.hh"
+#include "G4ParticleDefinition.hh"
 #include "G4ios.hh"
 #include "G4Event.hh"
-#include "G4GenericMessenger.hh"
 
 #include "G4SystemOfUnits.hh"
+#include "G4PhysicalConstants.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
 
 namespace ED
 {
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-EmCalorimeterSD::EmCalorimeterSD(const G4String& name)
- : G4VSensitiveDetector(name)
+EmCalorimeterSD::EmCalorimeterSD(const G4String& name,
+                                 const ChannelRange& channels)
+ : G4VSensitiveDetector(name),
+   fChannels(channels)
 {
-  // not working (for some reason the kew is read only once)
-  fMessenger = new G4GenericMessenger(this, "/log/", "Log control");
-  fMessenger->DeclareProperty("Nsteps", fNsteps, "Print the info with intervals Nsteps");
-  // working
-  std::ifstream inputFile("log.txt");
-  if (inputFile.is_open()) {
-    inputFile >> fNsteps;
-    } else {
-       fNsteps = 1; 
-    }
-  inputFile.close();
+  collectionName.insert(name + "HitsCollection");
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -73,30 +73,84 @@ EmCalorimeterSD::~EmCalorimeterSD()
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-void EmCalorimeterSD::Initialize(G4HCofThisEvent* /*hce*/)
+void EmCalorimeterSD::Initialize(G4HCofThisEvent* hce)
 {
-  G4String hcName = SensitiveDetectorName + "HitsCollection";
-
+  // Create the hits collection; the hits are created in EndOfEvent
+  // only for the detectors which got some energy
   fHitsCollection
-    = new EmCalorimeterHitsCollection(SensitiveDetectorName, hcName);
-  //G4cout << "SensitiveDetectorName: " << SensitiveDetectorName << G4endl;
-
-  // Create a hit for each detector
-  for (G4int i=1000; i<1100; ++i) {
-    auto newHit = new EmCalorimeterHit();
-    newHit->SetLayerNumber(i);
-    fHitsCollection->insert(newHit);
+    = new EmCalorimeterHitsCollection(SensitiveDetectorName, collectionName[0]);
+
+  // Add this collection in hce
+  if ( fHitsCollectionID < 0 ) {
+    fHitsCollectionID
+      = G4SDManager::GetSDMpointer()->GetCollectionID(fHitsCollection);
   }
-  for (G4int i=2000; i<2100; ++i) {
-    auto newHit = new EmCalorimeterHit();
-    newHit->SetLayerNumber(i);
-    fHitsCollection->insert(newHit);
+  hce->AddHitsCollection(fHitsCollectionID, fHitsCollection);
+
+  // The energy array is allocated only once
+  if ( fEdep.empty() ) {
+    fEdep.assign(fChannels.count, 0.);
+    fTouchedSlots.reserve(fChannels.count);
   }
-  for (G4int i=3000; i<3100; ++i) {
-    auto newHit = new EmCalorimeterHit();
-    newHit->SetLayerNumber(i);
-    fHitsCollection->insert(newHit);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EmCalorimeterSD::SetGridReadout(G4int nofPixels, G4double pitch)
+{
+  fReadout = Readout::kGrid;
+  fNofPixels = nofPixels;
+  fInvPitch = 1./pitch;
+  fOrigin = -0.5*nofPixels*pitch;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EmCalorimeterSD::SetPhiReadout(G4int nofSegments)
+{
+  fReadout = Readout::kPhi;
+  fNofPixels = nofSegments;
+  fInvSegment = nofSegments/twopi;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int EmCalorimeterSD::FindSlot(G4int copyNumber) const
+{
+  // The slot is the offset of the copy number in the owned range
+  auto slot = copyNumber - fChannels.firstCopyNo;
+  if ( slot < 0 || slot >= fChannels.count ) {
+    G4ExceptionDescription msg;
+    msg << "Volume copy " << copyNumber << " is not read out by "
+        << SensitiveDetectorName << " (copy numbers " << fChannels.firstCopyNo
+        << "-" << fChannels.firstCopyNo + fChannels.count - 1 << ")";
+    G4Exception("EmCalorimeterSD::FindSlot()", "laueDet0001",
+                FatalException, msg);
   }
+  return slot;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int EmCalorimeterSD::FindSlot(const G4VTouchable* touchable,
+                                const G4ThreeVector& position) const
+{
+  auto local
+    = touchable->GetHistory()->GetTopTransform().TransformPoint(position);
+
+  // The points on the volume surface are kept in the border pixels
+  if ( fReadout == Readout::kGrid ) {
+    auto i = (G4int)std::floor((local.x() - fOrigin)*fInvPitch);
+    auto j = (G4int)std::floor((local.y() - fOrigin)*fInvPitch);
+    i = std::min(std::max(i, 0), fNofPixels - 1);
+    j = std::min(std::max(j, 0), fNofPixels - 1);
+    return i*fNofPixels + j;
+  }
+
+  auto phi = std::atan2(local.y(), local.x());
+  if ( phi < 0. ) phi += twopi;
+  auto segment = (G4int)(phi*fInvSegment);
+  return std::min(segment, fNofPixels - 1);
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -104,58 +158,82 @@ void EmCalorimeterSD::Initialize(G4HCofThisEvent* /*hce*/)
 G4bool EmCalorimeterSD::ProcessHits(G4Step* step,
                                     G4TouchableHistory* /*history*/)
 {
+  LAUE_PROFILE_SCOPE(ProfileCounter::kProcessHits);
+
   // energy deposit
   auto edep = step->GetTotalEnergyDeposit();
   if ( edep == 0. ) return false;
 
   auto touchable = step->GetPreStepPoint()->GetTouchable();
-  auto copyNumber = touchable->GetCopyNumber();
-  G4int detectorNumber = (G4int)(copyNumber/1000);
-  auto arrayLayerNumber = copyNumber - detectorNumber*1000 + (detectorNumber - 1)*100; // must be from 0 to 299
-
-  // Get hit accounting data for this layer
-  auto hit = (*fHitsCollection)[arrayLayerNumber];
-  if ( hit == nullptr ) {
-    G4cerr << "Cannot access hit " << arrayLayerNumber << G4endl;
-    exit(1);
+  G4ThreeVector position;
+  if ( fReadout != Readout::kVolume ) {
+    // Virtual pixels: the steps are not limited at the pixel borders.
+    // A neutral particle deposits its energy at the interaction point,
+    // a charged one along the step (short at our energies).
+    auto pre = step->GetPreStepPoint()->GetPosition();
+    auto post = step->GetPostStepPoint()->GetPosition();
+    position
+      = ( step->GetTrack()->GetDefinition()->GetPDGCharge() == 0. )
+        ? post : 0.5*(pre + post);
   }
-
-  // Add the value of energy depositi to the hit
-  hit->AddEdep(edep);
+  AddDeposit(touchable, position, edep);
 
   return true;
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
+void EmCalorimeterSD::AddDeposit(const G4VTouchable* touchable,
+                                 const G4ThreeVector& position, G4double edep)
+{
+  auto slot = ( fReadout == Readout::kVolume )
+              ? FindSlot(touchable->GetCopyNumber())
+              : FindSlot(touchable, position);
+
+  // Add the value of energy deposit to the layer slot
+  if ( fEdep[slot] == 0. ) {
+    fTouchedSlots.push_back(slot);
+  }
+  fEdep[slot] += edep;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
 void EmCalorimeterSD::EndOfEvent(G4HCofThisEvent* /*hce*/)
 {
+  LAUE_PROFILE_SCOPE(ProfileCounter::kEndOfEvent);
+
   //G4cout << "> " <<  fHitsCollection->GetName()
   //       << ": in this event: " << G4endl;
-  
-  auto analysisManager = G4AnalysisManager::Instance();
-  const G4Event* currentEvent = G4RunManager::GetRunManager()->GetCurrentEvent();
-  G4int eventID = currentEvent->GetEventID()+1;
-  G4int nofHits = fHitsCollection->entries();
-  for ( G4int i=0; i<nofHits; i++ ) { // loop over all the detector
-     //(*fHitsCollection)[i]->Print();
-     // Add hits properties in the ntuple
-     G4double energyDeposit = ((*fHitsCollection)[i]->GetEdep())/keV;
-      if (energyDeposit > 0.) {
-        G4int detectorNo = (*fHitsCollection)[i]->GetLayerNumber();
-        if(!(eventID % fNsteps)) {
-           G4cout << "Event ID " << eventID << " ---> ";
-           G4cout << "Hit in the detector " << detectorNo
-              << "  Edep = " << std::setw(7) << energyDeposit << " keV" << G4endl;
-        }
-        analysisManager->FillNtupleIColumn(0, 0, eventID);
-        analysisManager->FillNtupleIColumn(0, 1, detectorNo);
-        analysisManager->FillNtupleDColumn(0, 2, energyDeposit);
-        analysisManager->AddNtupleRow(0);
-        // Increment the row count
-        fNtupleRowCount++;
-      }
+
+  // There is no current event when the SD is driven outside of a run
+  // (see benchmarks/sdBenchmark.cc)
+  auto runManager = G4RunManager::GetRunManager();
+  auto currentEvent = runManager ? runManager->GetCurrentEvent() : nullptr;
+  G4int eventID = currentEvent ? currentEvent->GetEventID()+1 : 0;
+
+  // The hits of one event every /log/printInterval events
+  auto printHits = currentEvent && Logger::IsPrintEvent(eventID);
+
+  // Keep the hits ordered by detector number
+  std::sort(fTouchedSlots.begin(), fTouchedSlots.end());
+
+  for ( auto slot : fTouchedSlots ) { // loop over the fired detectors only
+    // Create the hit and reset the slot for the next event
+    auto hit = new EmCalorimeterHit();
+    hit->SetLayerNumber(fChannels.first + slot);
+    hit->AddEdep(fEdep[slot]);
+    fHitsCollection->insert(hit);
+    fEdep[slot] = 0.;
+
+    // The hits are written in the ntuple by the EventAction
+    if ( printHits ) {
+      LAUE_LOG_INFO("Event ID " << eventID << " ---> "
+        << "Hit in the detector " << hit->GetLayerNumber()
+        << "  Edep = " << std::setw(7) << hit->GetEdep()/keV << " keV");
+    }
   }
+  fTouchedSlots.clear();
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -29,7 +29,16 @@
 /// \brief Implementation of the EventAction class
 
 #include "EventAction.hh"
+#include "EmCalorimeterHit.hh"
+#include "ColumnarWriter.hh"
+#include "SpectrumAccumulable.hh"
+#include "ProfileCounters.hh"
+#include "EventTracer.hh"
+
+#include "G4AnalysisManager.hh"
+#include "G4HCofThisEvent.hh"
 #include "G4Event.hh"
+#include "G4SystemOfUnits.hh"
 #include "G4ios.hh"
 
 namespace ED
@@ -49,6 +58,17 @@ EventAction::~EventAction()
 
 void EventAction::BeginOfEventAction(const G4Event* /*event*/)
 {
+  if ( EventTracer::IsEnabled() ) {
+    fEventStart = EventTracer::Now();
+  }
+
+#ifdef LAUE_PROFILING
+  // The first step is timed from the event start
+  if ( ProfileCounters::IsEnabled() && ProfileCounters::Instance() ) {
+    ProfileCounters::Instance()->StartStepping();
+  }
+#endif
+
   //G4int eventID = event -> GetEventID()+1;
   /*if(!(eventID % 10))
   {
@@ -59,15 +79,67 @@ void EventAction::BeginOfEventAction(const G4Event* /*event*/)
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-void EventAction::EndOfEventAction(const G4Event* /*event*/)
+void EventAction::EndOfEventAction(const G4Event* event)
+{
+  RecordHits(event);
+
+  // The event span includes the hits output
+  if ( EventTracer::IsEnabled() ) {
+    EventTracer::Add("Event", fEventStart, EventTracer::Now(), event->GetEventID());
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EventAction::RecordHits(const G4Event* event)
 {
-    // Get the event ID
-    //G4int eventID = event->GetEventID();
-    
-    /*if(!(eventID % 10))
-   {
-      G4cout << ">>> End event: " << eventID << G4endl;
-   }*/
+  auto hce = event->GetHCofThisEvent();
+  if ( hce == nullptr ) return;
+
+  // Collect the fired detectors of all hits collections
+  fDetectorIDs.clear();
+  fEnergies.clear();
+  for ( std::size_t i=0; i<hce->GetNumberOfCollections(); ++i ) {
+    auto hitsCollection
+      = dynamic_cast<EmCalorimeterHitsCollection*>(hce->GetHC(i));
+    if ( hitsCollection == nullptr ) continue;
+
+    for ( std::size_t j=0; j<hitsCollection->entries(); ++j ) {
+      auto hit = (*hitsCollection)[j];
+      fDetectorIDs.push_back(hit->GetLayerNumber());
+      fEnergies.push_back(hit->GetEdep()/keV);
+    }
+  }
+
+  // Online spectra
+  if ( fSpectra ) {
+    fSpectra->AddEvent();
+    for ( std::size_t i=0; i<fDetectorIDs.size(); ++i ) {
+      fSpectra->Fill(fDetectorIDs[i], fEnergies[i]*keV);
+    }
+  }
+
+  // Events without hits are not written
+  if ( fDetectorIDs.empty() || ! fWriteHits ) return;
+
+  LAUE_PROFILE_SCOPE(ProfileCounter::kOutputFill);
+
+  // Columnar output: one row per hit (see RunAction for the schema)
+  if ( fColumnarWriter ) {
+    for ( std::size_t i=0; i<fDetectorIDs.size(); ++i ) {
+      fColumnarWriter->Fill<int32_t>(0, event->GetEventID()+1);
+      fColumnarWriter->Fill<int32_t>(1, fDetectorIDs[i]);
+      fColumnarWriter->Fill<double>(2, fEnergies[i]);
+      fColumnarWriter->AddRow();
+    }
+    return;
+  }
+
+  // One ntuple row per event; the vector columns are filled
+  // automatically from fDetectorIDs and fEnergies
+  auto analysisManager = G4AnalysisManager::Instance();
+  analysisManager->FillNtupleIColumn(0, 0, event->GetEventID()+1);
+  analysisManager->AddNtupleRow(0);
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
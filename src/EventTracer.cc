@@ -0,0 +1,197 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+// $Id$
+//
+/// \file EventTracer.cc
+/// \brief Implementation of the EventTracer class
+
+#include "EventTracer.hh"
+#include "Logger.hh"
+
+#include "G4GenericMessenger.hh"
+#include "G4Threading.hh"
+#include "G4ios.hh"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+
+namespace
+{
+
+// Buffer of the current thread
+thread_local void* tBuffer = nullptr;
+
+}
+
+namespace ED
+{
+
+EventTracer* EventTracer::fgInstance = nullptr;
+std::atomic<G4bool> EventTracer::fgEnabled { false };
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+EventTracer::EventTracer()
+{
+  fgInstance = this;
+
+  fMessenger = new G4GenericMessenger(this, "/trace/", "Events timeline");
+  fMessenger->DeclareMethod("enable", &EventTracer::SetEnabled,
+    "Record the events and the end of run phases of each thread\n"
+    "and write them in a Chrome trace file at the end of the run");
+  fMessenger->DeclareProperty("fileName", fFileName,
+    "Prefix of the trace files <fileName>_run<N>.json");
+  fMessenger->DeclareProperty("maxSpans", fMaxSpans,
+    "Maximum number of spans recorded per thread and run");
+  SetMasterOnly("/trace/");
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+EventTracer::~EventTracer()
+{
+  delete fMessenger;
+  fgInstance = nullptr;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EventTracer::SetEnabled(G4bool enable)
+{
+  fgEnabled = enable;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EventTracer::Add(const char* name, Clock::time_point start,
+                      Clock::time_point end, G4int eventID)
+{
+  auto tracer = fgInstance;
+  if ( ! tracer ) return;
+
+  auto buffer = tracer->GetBuffer();
+  if ( buffer->spans.size() >= (std::size_t)std::max(tracer->fMaxSpans, 0) ) {
+    ++buffer->nofDropped;
+    return;
+  }
+  buffer->spans.push_back({ name, eventID, start, end });
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EventTracer::StartRun(G4int runID)
+{
+  if ( ! IsEnabled() ) return;
+
+  // The workers are not running: their buffers can be cleared
+  // (the buffers and their capacity are kept for the next runs)
+  std::lock_guard<std::mutex> lock(fBuffersMutex);
+  for ( const auto& buffer : fBuffers ) {
+    buffer->spans.clear();
+    buffer->nofDropped = 0;
+  }
+  fRunID = runID;
+  fRunStart = Now();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EventTracer::EndRun()
+{
+  if ( ! IsEnabled() ) return;
+
+  auto fileName = fFileName + "_run" + std::to_string(fRunID) + ".json";
+  if ( ! Write(fileName) ) {
+    G4ExceptionDescription msg;
+    msg << "Error writing " << fileName;
+    G4Exception("EventTracer::EndRun()", "laueDet0017", JustWarning, msg);
+    return;
+  }
+  G4cout << ">>> Trace of the run " << fRunID << " written in " << fileName << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+EventTracer::Buffer* EventTracer::GetBuffer()
+{
+  if ( ! tBuffer ) {
+    auto buffer = std::make_unique<Buffer>();
+    buffer->threadID = G4Threading::G4GetThreadId();
+    std::lock_guard<std::mutex> lock(fBuffersMutex);
+    tBuffer = buffer.get();
+    fBuffers.push_back(std::move(buffer));
+  }
+  return static_cast<Buffer*>(tBuffer);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool EventTracer::Write(const G4String& fileName) const
+{
+  std::ofstream output(fileName);
+  if ( ! output.is_open() ) return false;
+
+  // The master is the thread 0, the worker N the thread N+1;
+  // the times are in us from the start of the run
+  std::vector<const Buffer*> buffers;
+  for ( const auto& buffer : fBuffers ) buffers.push_back(buffer.get());
+  std::sort(buffers.begin(), buffers.end(),
+            [](const Buffer* a, const Buffer* b) { return a->threadID < b->threadID; });
+
+  std::size_t nofDropped = 0;
+  G4String separator = "\n";
+  output << std::fixed << std::setprecision(3)
+         << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+  for ( auto buffer : buffers ) {
+    auto tid = buffer->threadID + 1;
+    output << separator << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+           << tid << ",\"args\":{\"name\":\""
+           << ( buffer->threadID < 0 ? std::string("master")
+                                     : "worker " + std::to_string(buffer->threadID) )
+           << "\"}}";
+    separator = ",\n";
+    for ( const auto& span : buffer->spans ) {
+      std::chrono::duration<G4double, std::micro> start = span.start - fRunStart;
+      std::chrono::duration<G4double, std::micro> duration = span.end - span.start;
+      output << separator << "{\"name\":\"" << span.name
+             << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << tid
+             << ",\"ts\":" << start.count() << ",\"dur\":" << duration.count();
+      if ( span.eventID >= 0 ) {
+        output << ",\"args\":{\"eventID\":" << span.eventID << "}";
+      }
+      output << "}";
+    }
+    nofDropped += buffer->nofDropped;
+  }
+  output << "\n],\"otherData\":{\"run\":" << fRunID
+         << ",\"dropped_spans\":" << nofDropped << "}}\n";
+  return output.good();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
@@ -0,0 +1,152 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+// $Id$
+//
+/// \file FocalPlaneSource.cc
+/// \brief Implementation of the FocalPlaneSource class
+
+#include "FocalPlaneSource.hh"
+#include "LaueLens.hh"
+
+#include "G4Event.hh"
+#include "G4Gamma.hh"
+#include "G4GenericMessenger.hh"
+#include "G4PhysicalConstants.hh"
+#include "G4PrimaryParticle.hh"
+#include "G4PrimaryVertex.hh"
+#include "G4SystemOfUnits.hh"
+#include "Randomize.hh"
+
+#include <cmath>
+
+namespace
+{
+
+// Radius uniform over the annulus area
+G4double SampleRadius(G4double rMin, G4double rMax)
+{
+  return std::sqrt(rMin*rMin + (rMax*rMax - rMin*rMin)*G4UniformRand());
+}
+
+}
+
+namespace ED
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+FocalPlaneSource::FocalPlaneSource()
+ : fFocus(0., 0., -20.*cm),
+   fEntranceZ(-25.*cm),
+   fPolarisation(1., 0., 0.)
+{
+  fMessenger = new G4GenericMessenger(this, "/focalPlane/", "Laue lens focal plane source");
+  fMessenger->DeclareMethod("table", &FocalPlaneSource::SetTableFile,
+                            "Focal plane table file (see FocalPlaneTable.hh)");
+  fMessenger->DeclareMethod("useLens", &FocalPlaneSource::UseLens,
+                            "Use the table of the Laue lens model (/lens/build)");
+  fMessenger->DeclarePropertyWithUnit("focus", "cm", fFocus,
+                                      "Position of the lens focus");
+  fMessenger->DeclarePropertyWithUnit("entranceZ", "cm", fEntranceZ,
+                                      "z of the plane where the photons start");
+  fMessenger->DeclareProperty("polarization", fPolarisation,
+                              "Direction of the linear polarisation");
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+FocalPlaneSource::~FocalPlaneSource()
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void FocalPlaneSource::SetTableFile(const G4String& fileName)
+{
+  fTable = FocalPlaneTable::Load(fileName);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void FocalPlaneSource::UseLens()
+{
+  // Built on the master before the workers start their run
+  if ( LaueLens::Instance() ) fTable = LaueLens::Instance()->GetTable();
+  if ( ! fTable ) {
+    G4Exception("FocalPlaneSource::UseLens()", "laueDet0018", JustWarning,
+                "The Laue lens table is not built (/lens/build).");
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void FocalPlaneSource::GeneratePrimaryVertex(G4Event* event)
+{
+  if ( ! fTable ) {
+    G4Exception("FocalPlaneSource::GeneratePrimaryVertex()", "laueDet0018",
+                FatalException, "No focal plane table (/focalPlane/table or useLens).");
+    return;
+  }
+
+  const auto& bin = fTable->SampleBin(G4UniformRand());
+  auto energy = bin.eMin + (bin.eMax - bin.eMin)*G4UniformRand();
+
+  // Path from the lens to the focal plane
+  auto lensR = SampleRadius(bin.lensRMin, bin.lensRMax);
+  auto lensPhi = twopi*G4UniformRand();
+  auto spotR = SampleRadius(bin.spotRMin, bin.spotRMax);
+  auto spotPhi = twopi*G4UniformRand();
+  auto lens = fFocus + G4ThreeVector(lensR*std::cos(lensPhi), lensR*std::sin(lensPhi),
+                                     -fTable->GetFocalLength());
+  auto spot = fFocus + G4ThreeVector(spotR*std::cos(spotPhi), spotR*std::sin(spotPhi), 0.);
+  auto direction = (spot - lens).unit();
+  auto position = lens + direction*((fEntranceZ - lens.z())/direction.z());
+
+  // Linear polarisation, perpendicular to the direction
+  G4ThreeVector polarisation;
+  if ( G4UniformRand() < bin.polarisation ) {
+    polarisation = fPolarisation - direction*fPolarisation.dot(direction);
+  }
+  if ( polarisation.mag2() < 1.e-12 ) {
+    auto e1 = direction.orthogonal().unit();
+    auto e2 = direction.cross(e1);
+    auto angle = twopi*G4UniformRand();
+    polarisation = std::cos(angle)*e1 + std::sin(angle)*e2;
+  }
+
+  auto particle = new G4PrimaryParticle(G4Gamma::Definition());
+  particle->SetKineticEnergy(energy);
+  particle->SetMomentumDirection(direction);
+  particle->SetPolarization(polarisation.unit());
+  auto vertex = new G4PrimaryVertex(position, 0.);
+  vertex->SetPrimary(particle);
+  event->AddPrimaryVertex(vertex);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
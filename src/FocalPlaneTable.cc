@@ -0,0 +1,155 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+// $Id$
+//
+/// \file FocalPlaneTable.cc
+/// \brief Implementation of the FocalPlaneTable class
+
+#include "FocalPlaneTable.hh"
+
+#include "G4SystemOfUnits.hh"
+
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <sstream>
+
+namespace
+{
+
+std::vector<G4double> GetWeights(const std::vector<ED::FocalPlaneBin>& bins)
+{
+  std::vector<G4double> weights;
+  for ( const auto& bin : bins ) weights.push_back(bin.weight);
+  return weights;
+}
+
+}
+
+namespace ED
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+FocalPlaneTable::FocalPlaneTable(G4double focalLength,
+                                 std::vector<FocalPlaneBin> bins)
+ : fFocalLength(focalLength),
+   fBins(std::move(bins)),
+   fAliasTable(GetWeights(fBins))
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+std::shared_ptr<const FocalPlaneTable>
+FocalPlaneTable::Load(const G4String& fileName)
+{
+  static std::mutex mutex;
+  static std::map<G4String, std::shared_ptr<const FocalPlaneTable>> tables;
+
+  std::lock_guard<std::mutex> lock(mutex);
+  auto it = tables.find(fileName);
+  if ( it != tables.end() ) return it->second;
+
+  std::ifstream input(fileName);
+  if ( ! input.is_open() ) {
+    G4ExceptionDescription msg;
+    msg << "Cannot open the focal plane table " << fileName;
+    G4Exception("FocalPlaneTable::Load()", "laueDet0018", FatalException, msg);
+    return nullptr;
+  }
+
+  G4double focalLength = 0.;
+  std::vector<FocalPlaneBin> bins;
+  std::string line;
+  G4int lineNumber = 0;
+  while ( std::getline(input, line) ) {
+    ++lineNumber;
+    line = line.substr(0, line.find('#'));
+    std::istringstream fields(line);
+    std::string first;
+    if ( ! (fields >> first) ) continue;
+
+    if ( first == "focalLength" ) {
+      fields >> focalLength;
+      focalLength *= mm;
+    }
+    else {
+      FocalPlaneBin bin;
+      std::istringstream binFields(line);
+      binFields >> bin.eMin >> bin.eMax >> bin.lensRMin >> bin.lensRMax
+                >> bin.spotRMin >> bin.spotRMax >> bin.polarisation >> bin.weight;
+      if ( ! binFields ) {
+        G4ExceptionDescription msg;
+        msg << fileName << ":" << lineNumber << ": wrong focal plane bin";
+        G4Exception("FocalPlaneTable::Load()", "laueDet0018", FatalException, msg);
+        return nullptr;
+      }
+      bin.eMin *= keV;
+      bin.eMax *= keV;
+      bin.lensRMin *= mm;
+      bin.lensRMax *= mm;
+      bin.spotRMin *= mm;
+      bin.spotRMax *= mm;
+      bins.push_back(bin);
+    }
+  }
+
+  if ( focalLength <= 0. || bins.empty() ) {
+    G4ExceptionDescription msg;
+    msg << fileName << ": no focal length or no bins";
+    G4Exception("FocalPlaneTable::Load()", "laueDet0018", FatalException, msg);
+    return nullptr;
+  }
+
+  auto table = std::make_shared<const FocalPlaneTable>(focalLength, std::move(bins));
+  tables[fileName] = table;
+  return table;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool FocalPlaneTable::Write(const G4String& fileName) const
+{
+  std::ofstream output(fileName);
+  if ( ! output.is_open() ) return false;
+
+  output << "# Laue lens photon field at the focal plane\n"
+         << "focalLength " << fFocalLength/mm << "\n"
+         << "# eMin(keV) eMax(keV) lensRMin(mm) lensRMax(mm) spotRMin(mm) spotRMax(mm)"
+            " polarisation weight\n";
+  output.precision(10);
+  for ( const auto& bin : fBins ) {
+    output << bin.eMin/keV << " " << bin.eMax/keV << " "
+           << bin.lensRMin/mm << " " << bin.lensRMax/mm << " "
+           << bin.spotRMin/mm << " " << bin.spotRMax/mm << " "
+           << bin.polarisation << " " << bin.weight << "\n";
+  }
+  return output.good();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
@@ -0,0 +1,231 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+// $Id$
+//
+/// \file GeometryIndex.cc
+/// \brief Implementation of the GeometryIndex class
+
+#include "GeometryIndex.hh"
+
+#include "G4VPhysicalVolume.hh"
+#include "G4LogicalVolume.hh"
+#include "G4VPVParameterisation.hh"
+#include "G4Tubs.hh"
+#include "G4Point3D.hh"
+#include "G4PhysicalConstants.hh"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+
+ED::lut::Entry MakeEntry(G4int channel, const G4Transform3D& transform,
+                         const G4ThreeVector& localCentre)
+{
+  ED::lut::Entry entry {};
+  entry.channel = channel;
+  auto centre = transform * G4Point3D(localCentre);
+  entry.centre[0] = centre.x();
+  entry.centre[1] = centre.y();
+  entry.centre[2] = centre.z();
+  auto rotation = transform.getRotation();
+  G4double rows[9] = { rotation.xx(), rotation.xy(), rotation.xz(),
+                       rotation.yx(), rotation.yy(), rotation.yz(),
+                       rotation.zx(), rotation.zy(), rotation.zz() };
+  std::copy(rows, rows + 9, entry.rotation);
+  return entry;
+}
+
+// Mid radius of a tube (0 for other solids)
+G4double GetMidRadius(const G4VSolid* solid)
+{
+  auto tubs = dynamic_cast<const G4Tubs*>(solid);
+  return tubs ? 0.5*(tubs->GetInnerRadius() + tubs->GetOuterRadius()) : 0.;
+}
+
+}
+
+namespace ED
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void GeometryIndex::AddVolumeReadout(const G4String& volumeName,
+                                     const ChannelRange& channels)
+{
+  fReadouts.push_back({ volumeName, channels, Kind::kVolume, 0, 0. });
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void GeometryIndex::AddGridReadout(const G4String& volumeName,
+                                   const ChannelRange& channels,
+                                   G4int nofPixels, G4double pitch)
+{
+  fReadouts.push_back({ volumeName, channels, Kind::kGrid, nofPixels, pitch });
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void GeometryIndex::AddPhiReadout(const G4String& volumeName,
+                                  const ChannelRange& channels, G4int nofSegments)
+{
+  fReadouts.push_back({ volumeName, channels, Kind::kPhi, nofSegments, 0. });
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void GeometryIndex::Clear()
+{
+  fReadouts.clear();
+  fTable = lut::LookupTable();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void GeometryIndex::Build(G4VPhysicalVolume* worldPV)
+{
+  std::vector<lut::Entry> entries;
+  Walk(worldPV, G4Transform3D(), entries);
+  fTable = lut::LookupTable(std::move(entries));
+
+  std::size_t nofChannels = 0;
+  for ( const auto& readout : fReadouts ) nofChannels += readout.channels.count;
+  if ( fTable.GetSize() != nofChannels ) {
+    G4ExceptionDescription msg;
+    msg << fTable.GetSize() << " channels found in the geometry, "
+        << nofChannels << " expected.";
+    G4Exception("GeometryIndex::Build()", "laueDet0010", JustWarning, msg);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool GeometryIndex::GetCentre(G4int channel, G4ThreeVector& centre) const
+{
+  auto entry = fTable.Find(channel);
+  if ( ! entry ) return false;
+
+  centre.set(entry->centre[0], entry->centre[1], entry->centre[2]);
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool GeometryIndex::GetTransform(G4int channel, G4ThreeVector& centre,
+                                   G4RotationMatrix& rotation) const
+{
+  auto entry = fTable.Find(channel);
+  if ( ! entry ) return false;
+
+  centre.set(entry->centre[0], entry->centre[1], entry->centre[2]);
+  rotation = G4RotationMatrix(CLHEP::HepRep3x3(entry->rotation));
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void GeometryIndex::Walk(G4VPhysicalVolume* physVol,
+                         const G4Transform3D& motherTransform,
+                         std::vector<lut::Entry>& entries) const
+{
+  // A parameterised volume is positioned by its parameterisation
+  // for each of its copies
+  auto parameterisation = physVol->GetParameterisation();
+  auto nofCopies = parameterisation ? physVol->GetMultiplicity() : 1;
+
+  for ( G4int i=0; i<nofCopies; ++i ) {
+    if ( parameterisation ) {
+      parameterisation->ComputeTransformation(i, physVol);
+      physVol->SetCopyNo(i);
+    }
+    auto transform = motherTransform *
+      G4Transform3D(physVol->GetObjectRotationValue(), physVol->GetObjectTranslation());
+
+    for ( const auto& readout : fReadouts ) {
+      if ( readout.volumeName == physVol->GetLogicalVolume()->GetName() ) {
+        AddEntries(readout, physVol, transform, entries);
+      }
+    }
+
+    auto logicalVolume = physVol->GetLogicalVolume();
+    for ( std::size_t j=0; j<logicalVolume->GetNoDaughters(); ++j ) {
+      Walk(logicalVolume->GetDaughter(j), transform, entries);
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void GeometryIndex::AddEntries(const Readout& readout, G4VPhysicalVolume* physVol,
+                               const G4Transform3D& transform,
+                               std::vector<lut::Entry>& entries) const
+{
+  const auto& channels = readout.channels;
+  auto solid = physVol->GetLogicalVolume()->GetSolid();
+
+  if ( readout.kind == Kind::kVolume ) {
+    auto slot = physVol->GetCopyNo() - channels.firstCopyNo;
+    if ( slot < 0 || slot >= channels.count ) return;
+
+    // The centre of a tube segment is at its mid radius and mid phi
+    G4ThreeVector localCentre;
+    auto tubs = dynamic_cast<const G4Tubs*>(solid);
+    if ( tubs && tubs->GetDeltaPhiAngle() < twopi ) {
+      localCentre.setRhoPhiZ(GetMidRadius(tubs),
+        tubs->GetStartPhiAngle() + 0.5*tubs->GetDeltaPhiAngle(), 0.);
+    }
+    entries.push_back(MakeEntry(channels.first + slot, transform, localCentre));
+    return;
+  }
+
+  if ( readout.kind == Kind::kGrid ) {
+    // Same pixels numbering as PixelParameterisation
+    auto n = readout.nofPixels;
+    auto origin = -0.5*(n - 1)*readout.pitch;
+    for ( G4int k=0; k<channels.count; ++k ) {
+      G4ThreeVector localCentre(origin + (k/n)*readout.pitch,
+                                origin + (k%n)*readout.pitch, 0.);
+      entries.push_back(MakeEntry(channels.first + k, transform, localCentre));
+    }
+    return;
+  }
+
+  // Phi segments, oriented as the segments of the volume readout
+  auto radius = GetMidRadius(solid);
+  auto dphi = twopi/readout.nofPixels;
+  for ( G4int k=0; k<channels.count; ++k ) {
+    auto segmentTransform = transform * G4RotateZ3D(k*dphi);
+    G4ThreeVector localCentre;
+    localCentre.setRhoPhiZ(radius, 0.5*dphi, 0.);
+    entries.push_back(MakeEntry(channels.first + k, segmentTransform, localCentre));
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
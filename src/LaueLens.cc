@@ -0,0 +1,226 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+// $Id$
+//
+/// \file LaueLens.cc
+/// \brief Implementation of the LaueLens class
+
+#include "LaueLens.hh"
+#include "Logger.hh"
+
+#include "G4GenericMessenger.hh"
+#include "G4PhysicalConstants.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4ios.hh"
+
+#include <cmath>
+#include <sstream>
+
+namespace
+{
+
+// Integration steps per energy bin and per tile side
+constexpr G4int kNofEnergySteps = 8;
+constexpr G4int kNofTileSteps = 8;
+
+}
+
+namespace ED
+{
+
+LaueLens* LaueLens::fgInstance = nullptr;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+LaueLens::LaueLens()
+ : fFocalLength(20.*m),
+   fEMin(100.*keV),
+   fEMax(300.*keV),
+   fSpotRMax(20.*mm)
+{
+  fgInstance = this;
+
+  fMessenger = new G4GenericMessenger(this, "/lens/", "Laue lens model");
+  fMessenger->DeclarePropertyWithUnit("focalLength", "m", fFocalLength,
+                                      "Focal length of the lens");
+  fMessenger->DeclareMethod("addRing", &LaueLens::AddRingCommand,
+    "Add a ring of crystal tiles: radius(cm) dSpacing(angstrom)\n"
+    "mosaicity(arcmin) tileSize(mm) peakReflectivity");
+  fMessenger->DeclareMethod("clearRings", &LaueLens::ClearRings,
+                            "Remove all the rings");
+  fMessenger->DeclarePropertyWithUnit("eMin", "keV", fEMin,
+                                      "Lower edge of the energy bins");
+  fMessenger->DeclarePropertyWithUnit("eMax", "keV", fEMax,
+                                      "Upper edge of the energy bins");
+  fMessenger->DeclareProperty("nofEnergyBins", fNofEnergyBins,
+                              "Number of energy bins");
+  fMessenger->DeclarePropertyWithUnit("spotRMax", "mm", fSpotRMax,
+    "Radius of the point spread function table (the photons\n"
+    "diffracted farther from the focus are not generated)");
+  fMessenger->DeclareProperty("nofSpotBins", fNofSpotBins,
+                              "Number of radial bins of the point spread function");
+  fMessenger->DeclareProperty("spectralIndex", fSpectralIndex,
+                              "Photon index of the source spectrum (E^-index)");
+  fMessenger->DeclareProperty("polarization", fPolarisation,
+                              "Linear polarisation degree of the source");
+  fMessenger->DeclareMethod("build", &LaueLens::Build,
+                            "Compute the focal plane table of the lens");
+  fMessenger->DeclareMethod("write", &LaueLens::WriteTable,
+                            "Write the focal plane table in a file");
+  SetMasterOnly("/lens/");
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+LaueLens::~LaueLens()
+{
+  delete fMessenger;
+  fgInstance = nullptr;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void LaueLens::AddRingCommand(const G4String& parameters)
+{
+  Ring ring;
+  std::istringstream fields(parameters);
+  fields >> ring.radius >> ring.dSpacing >> ring.mosaicity
+         >> ring.tileSize >> ring.reflectivity;
+  if ( ! fields || ring.radius <= 0. || ring.dSpacing <= 0. ||
+       ring.mosaicity <= 0. || ring.tileSize <= 0. ) {
+    G4ExceptionDescription msg;
+    msg << "Wrong ring parameters: " << parameters << ", the ring is ignored.";
+    G4Exception("LaueLens::AddRingCommand()", "laueDet0019", JustWarning, msg);
+    return;
+  }
+  ring.radius *= cm;
+  ring.dSpacing *= angstrom;
+  ring.mosaicity *= arcmin;
+  ring.tileSize *= mm;
+  AddRing(ring);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void LaueLens::Build()
+{
+  if ( fRings.empty() || fNofEnergyBins < 1 || fNofSpotBins < 1 || fEMax <= fEMin ) {
+    G4Exception("LaueLens::Build()", "laueDet0019", JustWarning,
+                "No rings or empty binning, the lens table is not built.");
+    return;
+  }
+
+  auto energyBin = (fEMax - fEMin)/fNofEnergyBins;
+  auto spotBin = fSpotRMax/fNofSpotBins;
+  std::vector<FocalPlaneBin> bins;
+  std::vector<G4double> effectiveAreas(fNofEnergyBins, 0.);
+  G4double geometricArea = 0.;
+
+  for ( const auto& ring : fRings ) {
+    auto nofTiles = std::floor(twopi*ring.radius/ring.tileSize);
+    auto area = nofTiles*ring.tileSize*ring.tileSize;
+    geometricArea += area;
+    auto braggAngle = 0.5*std::atan(ring.radius/fFocalLength);
+    auto sigma = ring.mosaicity/(2.*std::sqrt(2.*std::log(2.)));
+
+    for ( G4int i=0; i<fNofEnergyBins; ++i ) {
+      auto eLow = fEMin + i*energyBin;
+      std::vector<G4double> psf(fNofSpotBins, 0.);
+      for ( G4int k=0; k<kNofEnergySteps; ++k ) {
+        auto energy = eLow + (k + 0.5)*energyBin/kNofEnergySteps;
+        auto sinTheta = h_Planck*c_light/(2.*ring.dSpacing*energy);
+        if ( sinTheta >= 1. ) continue;
+
+        // Fraction of the tile area diffracting this energy
+        auto tilt = std::asin(sinTheta) - braggAngle;
+        if ( std::abs(tilt) > 5.*sigma ) continue;
+        auto reflectivity = ring.reflectivity*std::exp(-0.5*tilt*tilt/(sigma*sigma));
+        effectiveAreas[i] += area*reflectivity/kNofEnergySteps;
+
+        // Radial offset of the diffracted path in the focal plane,
+        // spread over the tile
+        auto offset = 2.*tilt*fFocalLength;
+        auto step = ring.tileSize/kNofTileSteps;
+        auto weight = reflectivity/(kNofEnergySteps*kNofTileSteps*kNofTileSteps);
+        for ( G4int u=0; u<kNofTileSteps; ++u ) {
+          auto x = offset + (u + 0.5)*step - 0.5*ring.tileSize;
+          for ( G4int v=0; v<kNofTileSteps; ++v ) {
+            auto y = (v + 0.5)*step - 0.5*ring.tileSize;
+            auto j = (std::size_t)(std::hypot(x, y)/spotBin);
+            if ( j < psf.size() ) psf[j] += weight;
+          }
+        }
+      }
+
+      auto spectrum = std::pow((eLow + 0.5*energyBin)/keV, -fSpectralIndex);
+      for ( G4int j=0; j<fNofSpotBins; ++j ) {
+        if ( psf[j] <= 0. ) continue;
+        bins.push_back({ eLow, eLow + energyBin,
+                         ring.radius - 0.5*ring.tileSize, ring.radius + 0.5*ring.tileSize,
+                         j*spotBin, (j + 1)*spotBin, fPolarisation,
+                         area/cm2*psf[j]*spectrum*energyBin/keV });
+      }
+    }
+  }
+
+  if ( bins.empty() ) {
+    G4Exception("LaueLens::Build()", "laueDet0019", JustWarning,
+                "The lens diffracts no photons in the energy range, "
+                "the lens table is not built.");
+    return;
+  }
+  fTable = std::make_shared<const FocalPlaneTable>(fFocalLength, std::move(bins));
+
+  std::size_t peak = 0;
+  for ( std::size_t i=1; i<effectiveAreas.size(); ++i ) {
+    if ( effectiveAreas[i] > effectiveAreas[peak] ) peak = i;
+  }
+  G4cout << ">>> Laue lens: " << fRings.size() << " rings, geometric area "
+         << geometricArea/cm2 << " cm2, peak effective area "
+         << effectiveAreas[peak]/cm2 << " cm2 at "
+         << (fEMin + (peak + 0.5)*energyBin)/keV << " keV, "
+         << fTable->GetBins().size() << " table bins" << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void LaueLens::WriteTable(const G4String& fileName)
+{
+  if ( ! fTable ) Build();
+  if ( ! fTable ) return;
+
+  if ( ! fTable->Write(fileName) ) {
+    G4ExceptionDescription msg;
+    msg << "Error writing " << fileName;
+    G4Exception("LaueLens::WriteTable()", "laueDet0019", JustWarning, msg);
+    return;
+  }
+  G4cout << ">>> Laue lens table written in " << fileName << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
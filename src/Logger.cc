@@ -0,0 +1,267 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+// $Id$
+//
+/// \file Logger.cc
+/// \brief Implementation of the Logger class
+
+#include "Logger.hh"
+
+#include "G4GenericMessenger.hh"
+#include "G4Threading.hh"
+#include "G4UIcommand.hh"
+#include "G4UIcommandTree.hh"
+#include "G4UImanager.hh"
+#include "G4ios.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+
+namespace
+{
+
+// Ring buffer of the current thread
+thread_local void* tRing = nullptr;
+
+const char* GetLevelName(ED::LogLevel level)
+{
+  switch ( level ) {
+    case ED::LogLevel::kDebug:   return "debug";
+    case ED::LogLevel::kInfo:    return "info";
+    case ED::LogLevel::kWarning: return "warning";
+    case ED::LogLevel::kError:   return "error";
+  }
+  return "";
+}
+
+}
+
+namespace ED
+{
+
+Logger* Logger::fgInstance = nullptr;
+std::atomic<G4int> Logger::fgLevel { (G4int)LogLevel::kInfo };
+std::atomic<G4int> Logger::fgPrintInterval { 1000 };
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+Logger::Logger()
+{
+  fgInstance = this;
+
+  fMessenger = new G4GenericMessenger(this, "/log/", "Log control");
+  fMessenger->DeclareMethod("level", &Logger::SetLevel,
+    "Minimum level of the printed messages (debug messages are\n"
+    "compiled only in the debug builds)")
+    .SetCandidates("debug info warning error")
+    .SetDefaultValue("info");
+  fMessenger->DeclareMethod("printInterval", &Logger::SetPrintInterval,
+    "Print the hits of one event every printInterval events")
+    .SetDefaultValue("1000");
+  fMessenger->DeclareProperty("fileName", fFileName,
+    "Prefix of the run log files <fileName>_run<N>.log\n"
+    "(empty: the messages are printed on the output)");
+  SetMasterOnly("/log/");
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+Logger::~Logger()
+{
+  CloseFile();
+  delete fMessenger;
+  fgInstance = nullptr;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void Logger::Log(LogLevel level, const std::string& message)
+{
+  auto logger = fgInstance;
+  if ( logger && logger->fOpen.load(std::memory_order_acquire) ) {
+    logger->Push(level, message);
+    return;
+  }
+
+  if ( level >= LogLevel::kWarning ) {
+    G4cerr << message << G4endl;
+  }
+  else {
+    G4cout << message << G4endl;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void Logger::OpenFile(G4int runID)
+{
+  CloseFile();
+  if ( fFileName.empty() ) return;
+
+  auto fileName = fFileName + "_run" + std::to_string(runID) + ".log";
+  auto file = std::make_unique<std::ofstream>(fileName);
+  if ( ! file->is_open() ) {
+    G4ExceptionDescription msg;
+    msg << "Cannot open " << fileName << ", the messages are printed on the output.";
+    G4Exception("Logger::OpenFile()", "laueDet0012", JustWarning, msg);
+    return;
+  }
+  fFile = std::move(file);
+  fNofDropped = 0;
+  fStop = false;
+  fWriter = std::thread(&Logger::WriterLoop, this);
+  fOpen.store(true, std::memory_order_release);
+  G4cout << ">>> Messages of the run " << runID << " written in " << fileName << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void Logger::CloseFile()
+{
+  if ( ! fFile ) return;
+
+  // The workers have finished their run: stop the writer
+  // and write the messages left in the buffers
+  fOpen.store(false, std::memory_order_release);
+  fStop = true;
+  fWriter.join();
+  Drain();
+
+  if ( fNofDropped > 0 ) {
+    *fFile << fNofDropped << " messages dropped (full buffers)" << std::endl;
+  }
+  fFile.reset();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+Logger::Ring* Logger::GetRing()
+{
+  if ( ! tRing ) {
+    auto ring = std::make_unique<Ring>();
+    ring->threadID = G4Threading::G4GetThreadId();
+    std::lock_guard<std::mutex> lock(fRingsMutex);
+    tRing = ring.get();
+    fRings.push_back(std::move(ring));
+  }
+  return static_cast<Ring*>(tRing);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void Logger::Push(LogLevel level, const std::string& message)
+{
+  auto ring = GetRing();
+  auto head = ring->head.load(std::memory_order_relaxed);
+  if ( head - ring->tail.load(std::memory_order_acquire) >= kRingSize ) {
+    ++fNofDropped;
+    return;
+  }
+
+  auto& record = ring->records[head % kRingSize];
+  record.level = level;
+  record.length = (G4int)std::min(message.size(), kMessageSize);
+  std::memcpy(record.text, message.data(), record.length);
+  ring->head.store(head + 1, std::memory_order_release);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+std::size_t Logger::Drain()
+{
+  std::vector<Ring*> rings;
+  {
+    std::lock_guard<std::mutex> lock(fRingsMutex);
+    for ( const auto& ring : fRings ) rings.push_back(ring.get());
+  }
+
+  std::size_t nofRecords = 0;
+  for ( auto ring : rings ) {
+    auto tail = ring->tail.load(std::memory_order_relaxed);
+    auto head = ring->head.load(std::memory_order_acquire);
+    for ( ; tail < head; ++tail ) {
+      const auto& record = ring->records[tail % kRingSize];
+      if ( ring->threadID < 0 ) {
+        *fFile << "G4MT ";
+      }
+      else {
+        *fFile << "G4WT" << ring->threadID << " ";
+      }
+      *fFile << "[" << GetLevelName(record.level) << "] ";
+      fFile->write(record.text, record.length);
+      *fFile << '\n';
+      ++nofRecords;
+    }
+    ring->tail.store(head, std::memory_order_release);
+  }
+  return nofRecords;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void Logger::WriterLoop()
+{
+  while ( ! fStop ) {
+    if ( Drain() == 0 ) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void Logger::SetLevel(const G4String& level)
+{
+  auto value = LogLevel::kInfo;
+  if      ( level == "debug" )   value = LogLevel::kDebug;
+  else if ( level == "warning" ) value = LogLevel::kWarning;
+  else if ( level == "error" )   value = LogLevel::kError;
+  fgLevel = (G4int)value;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void Logger::SetPrintInterval(G4int interval)
+{
+  fgPrintInterval = std::max(interval, 1);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void SetMasterOnly(const G4String& directory)
+{
+  auto tree = G4UImanager::GetUIpointer()->GetTree()->FindCommandTree(directory);
+  if ( tree == nullptr ) return;
+  for ( G4int i=1; i<=(G4int)tree->GetCommandEntry(); ++i ) {
+    tree->GetCommand(i)->SetToBeBroadcasted(false);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
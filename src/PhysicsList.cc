@@ -0,0 +1,280 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+// $Id$
+//
+/// \file PhysicsList.cc
+/// \brief Implementation of the PhysicsList class
+
+#include "PhysicsList.hh"
+
+#include "G4GenericMessenger.hh"
+#include "G4EmLivermorePolarizedPhysics.hh"
+#include "G4EmLivermorePhysics.hh"
+#include "G4EmPenelopePhysics.hh"
+#include "G4EmStandardPhysics.hh"
+#include "G4EmStandardPhysics_option4.hh"
+#include "G4EmParameters.hh"
+#include "G4Material.hh"
+#include "G4RegionStore.hh"
+#include "G4ProductionCuts.hh"
+#include "G4StateManager.hh"
+#include "G4Version.hh"
+#include "G4SystemOfUnits.hh"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#include <unistd.h>
+
+namespace
+{
+  // The startup time is counted from the program start
+  const auto jobStart = std::chrono::steady_clock::now();
+
+  // The file which marks a complete cache directory
+  const char* kParametersFile = "physics_parameters.txt";
+}
+
+namespace ED
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+PhysicsList::PhysicsList(const G4String& emName)
+ : fEmName(emName)
+{
+  SetVerboseLevel(1);
+  RegisterPhysics(CreateEmPhysics(fEmName));
+  // Coarse cut in the vacuum world; the detectors have their own cut
+  // (FocalPlane region, /detector/detectorCut)
+  SetDefaultCutValue(1.*mm);
+
+  // The physics list exists only on the master
+  fMessenger = new G4GenericMessenger(this, "/physics/", "Physics list control");
+  fMessenger->DeclareMethod("em", &PhysicsList::SetEmPhysics,
+    "Electromagnetic physics constructor (before /run/initialize)")
+    .SetCandidates(GetEmNames())
+    .SetStates(G4State_PreInit)
+    .command->SetToBeBroadcasted(false);
+  fMessenger->DeclareProperty("tableCache", fTableCache,
+    "Directory where the physics tables are stored by the first job\n"
+    "and retrieved by the next ones (empty: no cache)")
+    .SetStates(G4State_PreInit, G4State_Idle)
+    .command->SetToBeBroadcasted(false);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+PhysicsList::~PhysicsList()
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4String PhysicsList::GetEmNames()
+{
+  return "livermorePolarized livermore penelope standard standard_opt4";
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool PhysicsList::IsEmName(const G4String& name)
+{
+  std::istringstream names(GetEmNames());
+  std::string candidate;
+  while ( names >> candidate ) {
+    if ( candidate == name ) return true;
+  }
+  return false;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4VPhysicsConstructor* PhysicsList::CreateEmPhysics(const G4String& name)
+{
+  if ( name == "livermorePolarized" ) return new G4EmLivermorePolarizedPhysics();
+  if ( name == "livermore" )          return new G4EmLivermorePhysics();
+  if ( name == "penelope" )           return new G4EmPenelopePhysics();
+  if ( name == "standard" )           return new G4EmStandardPhysics();
+  if ( name == "standard_opt4" )      return new G4EmStandardPhysics_option4();
+
+  G4ExceptionDescription msg;
+  msg << "Unknown electromagnetic physics " << name
+      << " (" << GetEmNames() << ")";
+  G4Exception("PhysicsList::CreateEmPhysics()", "laueDet0021",
+              FatalException, msg);
+  return nullptr;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PhysicsList::SetEmPhysics(const G4String& name)
+{
+  if ( name == fEmName ) return;
+
+  // The constructor of the same type (electromagnetic) is replaced
+  ReplacePhysics(CreateEmPhysics(name));
+  fEmName = name;
+  G4cout << "Electromagnetic physics: " << fEmName << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4String PhysicsList::GetPhysicsParameters() const
+{
+  // All the parameters which define the tables
+  std::ostringstream parameters;
+  parameters << std::setprecision(17)
+             << "geant4 " << G4VERSION_NUMBER << '\n'
+             << "em " << fEmName << '\n'
+             << *G4EmParameters::Instance();
+  for ( auto material : *G4Material::GetMaterialTable() ) {
+    parameters << "material " << material->GetName() << ' '
+               << material->GetDensity() << '\n';
+  }
+  parameters << "defaultCut " << GetDefaultCutValue() << '\n';
+  for ( auto region : *G4RegionStore::GetInstance() ) {
+    parameters << "region " << region->GetName();
+    if ( auto cuts = region->GetProductionCuts() ) {
+      for ( auto cut : cuts->GetProductionCuts() ) parameters << ' ' << cut;
+    }
+    parameters << '\n';
+  }
+  return parameters.str();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PhysicsList::PrepareTableCache()
+{
+  fTableParameters = GetPhysicsParameters();
+
+  // 64-bit FNV-1a hash
+  uint64_t hash = 14695981039346656037ull;
+  for ( auto c : fTableParameters ) {
+    hash ^= (unsigned char)c;
+    hash *= 1099511628211ull;
+  }
+  std::ostringstream hex;
+  hex << std::hex << std::setw(16) << std::setfill('0') << hash;
+  fTableDirectory = fTableCache + "/" + hex.str();
+
+  // The directory is complete when it contains the parameters file,
+  // written last (and compared to exclude a hash collision)
+  std::ifstream input(fTableDirectory + "/" + kParametersFile);
+  std::ostringstream cached;
+  cached << input.rdbuf();
+  if ( input.is_open() && cached.str() == fTableParameters ) {
+    SetPhysicsTableRetrieved(fTableDirectory);
+    fRetrieveTables = true;
+    G4cout << ">>> Physics tables retrieved from " << fTableDirectory << G4endl;
+  }
+  else {
+    fStoreTables = true;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PhysicsList::StoreTableCache()
+{
+  // The tables are written in a temporary directory renamed at the end,
+  // so that the jobs started together do not read or write
+  // an incomplete directory
+  auto temporary = fTableDirectory + ".tmp" + std::to_string(::getpid());
+  std::error_code error;
+  std::filesystem::create_directories(temporary, error);
+  auto stored = ! error && StorePhysicsTable(temporary);
+  if ( stored ) {
+    std::ofstream output(temporary + "/" + kParametersFile);
+    output << fTableParameters;
+    output.close();
+    stored = ! output.fail();
+  }
+  if ( stored ) {
+    std::filesystem::rename(temporary, fTableDirectory, error);
+    // Another job stored the same tables first
+    if ( error && std::filesystem::exists(fTableDirectory + "/" + kParametersFile) ) {
+      error.clear();
+    }
+    stored = ! error;
+  }
+  std::filesystem::remove_all(temporary, error);
+
+  if ( ! stored ) {
+    G4ExceptionDescription msg;
+    msg << "Cannot store the physics tables in " << fTableDirectory;
+    G4Exception("PhysicsList::StoreTableCache()", "laueDet0022",
+                JustWarning, msg);
+    return;
+  }
+  G4cout << ">>> Physics tables stored in " << fTableDirectory << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool PhysicsList::Notify(G4ApplicationState requestedState)
+{
+  // The list is registered in the state manager of the master thread,
+  // which builds (or retrieves) the tables shared by the workers.
+  // The state is not changed yet.
+  auto currentState = G4StateManager::GetStateManager()->GetCurrentState();
+
+  // Idle -> Init: initialisation of the first run
+  if ( ! fTablesReady && currentState == G4State_Idle &&
+       requestedState == G4State_Init ) {
+    if ( ! fTableCache.empty() ) PrepareTableCache();
+    fBuildingTables = true;
+    fTablesTimer.Start();
+  }
+
+  // Init -> Idle: the tables are ready
+  else if ( fBuildingTables && currentState == G4State_Init &&
+            requestedState == G4State_Idle ) {
+    fTablesTimer.Stop();
+    fBuildingTables = false;
+    fTablesReady = true;
+    // Geant4 builds the tables when the retrieved cuts do not match
+    auto retrieved = fRetrieveTables && IsPhysicsTableRetrieved();
+    if ( fStoreTables ) StoreTableCache();
+
+    std::chrono::duration<G4double> startup
+      = std::chrono::steady_clock::now() - jobStart;
+    G4cout << ">>> Physics tables " << ( retrieved ? "retrieved" : "built" )
+           << " in " << fTablesTimer.GetRealElapsed() << " s, job startup "
+           << startup.count() << " s" << G4endl;
+  }
+
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
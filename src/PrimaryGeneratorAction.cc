@@ -1,31 +1,108 @@
 #include "PrimaryGeneratorAction.hh"
 #include "DetectorConstruction.hh"
+#include "FocalPlaneSource.hh"
+#include "ProfileCounters.hh"
 
 #include "G4Event.hh"
+#include "G4PrimaryVertex.hh"
 #include "G4GeneralParticleSource.hh"
+#include "G4GenericMessenger.hh"
 #include "G4ParticleTable.hh"
 #include "G4ParticleDefinition.hh"
 #include "globals.hh"
 #include "Randomize.hh"
 
+#include <algorithm>
+
 
 // Constructor
 PrimaryGeneratorAction::PrimaryGeneratorAction()
 {
     particleGun = new G4GeneralParticleSource();
+    focalPlaneSource = new ED::FocalPlaneSource();
+
+    messenger = new G4GenericMessenger(this, "/generator/", "Primary generator");
+    messenger->DeclareProperty("type", generatorType,
+        "Primaries generator: gps (General Particle Source)\n"
+        "or focalPlane (Laue lens focal plane source)")
+        .SetCandidates("gps focalPlane");
+    messenger->DeclareProperty("acceptance", acceptanceMode,
+        "Primaries which cannot reach a detector: off (tracked),\n"
+        "discard (empty event) or resample (sampled again; the results\n"
+        "are normalised by the number of samples of the run)")
+        .SetCandidates("off discard resample");
+    messenger->DeclareProperty("maxTries", maxTries,
+        "Maximum number of samples per event in resample mode");
 }
 
 
 // Destructor
 PrimaryGeneratorAction::~PrimaryGeneratorAction()
 {
+    delete messenger;
+    delete focalPlaneSource;
     delete particleGun;
 }
 
 
 void PrimaryGeneratorAction::GeneratePrimaries(G4Event* anEvent)
 {
-    particleGun -> GeneratePrimaryVertex(anEvent);
+    LAUE_PROFILE_SCOPE(ED::ProfileCounter::kGeneratePrimaries);
+    if ( acceptanceMode == "off" ) {
+        GenerateEvent(anEvent);
+        nofSamples += 1.;
+        return;
+    }
+
+    // The accepted events keep their weight: the rejected samples are
+    // accounted for by the number of samples of the run
+    nofSamples += GenerateAcceptedEvent(anEvent);
+}
+
+
+void PrimaryGeneratorAction::GenerateEvent(G4Event* anEvent)
+{
+    if ( generatorType == "focalPlane" ) {
+        focalPlaneSource -> GeneratePrimaryVertex(anEvent);
+    }
+    else {
+        particleGun -> GeneratePrimaryVertex(anEvent);
+    }
+}
+
+
+// The primaries are sampled in a scratch event, as the vertices of an
+// event cannot be removed, and copied in the event when accepted.
+// The copy constructor of G4PrimaryVertex also copies the next vertices
+// of the chain: each vertex is detached before its copy.
+// Returns the number of samples.
+G4int PrimaryGeneratorAction::GenerateAcceptedEvent(G4Event* anEvent)
+{
+    auto nofTries = ( acceptanceMode == "resample" ) ? std::max(maxTries, 1) : 1;
+    for ( G4int tries=1; tries<=nofTries; ++tries ) {
+        G4Event sample(anEvent->GetEventID());
+        GenerateEvent(&sample);
+        if ( ! acceptanceFilter.IsAccepted(&sample) ) continue;
+
+        G4PrimaryVertex* next = nullptr;
+        for ( auto vertex = sample.GetPrimaryVertex(); vertex; vertex = next ) {
+            next = vertex->GetNext();
+            vertex->ClearNext();
+            anEvent->AddPrimaryVertex(new G4PrimaryVertex(*vertex));
+            vertex->SetNext(next);
+        }
+        return tries;
+    }
+
+    // No accepted primaries: the event is empty
+    if ( acceptanceMode == "resample" ) {
+        G4ExceptionDescription msg;
+        msg << "No primaries reach a detector after " << nofTries
+            << " samples, the event is empty.";
+        G4Exception("PrimaryGeneratorAction::GeneratePrimaries()", "laueDet0020",
+                    JustWarning, msg);
+    }
+    return nofTries;
 }
 
 
@@ -0,0 +1,146 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+// $Id$
+//
+/// \file ProfileCounters.cc
+/// \brief Implementation of the ProfileCounters class
+
+#include "ProfileCounters.hh"
+
+#include "G4Threading.hh"
+#include "G4ios.hh"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+
+namespace
+{
+
+const char* kCounterNames[ED::ProfileCounters::kNofCounters] = {
+  "GeneratePrimaries",
+  "Stepping/detectorA",
+  "Stepping/detectorB",
+  "Stepping/detectorC",
+  "Stepping/other",
+  "ProcessHits",
+  "EndOfEvent",
+  "OutputFill",
+  "OutputWrite"
+};
+
+G4double ToSeconds(std::chrono::steady_clock::rep time)
+{
+  return std::chrono::duration<G4double>(std::chrono::steady_clock::duration(time)).count();
+}
+
+}
+
+namespace ED
+{
+
+G4ThreadLocal ProfileCounters* ProfileCounters::fgInstance = nullptr;
+std::atomic<G4bool> ProfileCounters::fgEnabled { false };
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+ProfileCounters::ProfileCounters(const G4String& name)
+ : G4VAccumulable(name)
+{
+  Reset();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ProfileCounters::Merge(const G4VAccumulable& other)
+{
+  const auto& otherCounters = static_cast<const ProfileCounters&>(other);
+  for ( std::size_t i=0; i<kNofCounters; ++i ) {
+    fTimes[i] += otherCounters.fTimes[i];
+    fCalls[i] += otherCounters.fCalls[i];
+  }
+  fNofThreads += otherCounters.fNofThreads;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ProfileCounters::Reset()
+{
+  fTimes.fill(0);
+  fCalls.fill(0);
+  // The master of a multi-threaded run processes no event
+  fNofThreads = ( G4Threading::IsMultithreadedApplication() &&
+                  G4Threading::IsMasterThread() ) ? 0 : 1;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ProfileCounters::Print(G4double wallTime) const
+{
+  auto threadsTime = wallTime*std::max(fNofThreads, 1);
+  G4cout << G4endl
+         << "--------------------- Hot paths profile ("
+         << fNofThreads << " threads, event loop " << wallTime << " s)" << G4endl
+         << std::setw(20) << std::left << "counter" << std::right
+         << std::setw(12) << "calls" << std::setw(12) << "total(s)"
+         << std::setw(14) << "per thread(s)" << std::setw(12) << "mean(us)"
+         << std::setw(10) << "time(%)" << G4endl;
+  for ( std::size_t i=0; i<kNofCounters; ++i ) {
+    auto total = ToSeconds(fTimes[i]);
+    G4cout << std::setw(20) << std::left << kCounterNames[i] << std::right
+           << std::setw(12) << fCalls[i]
+           << std::setw(12) << std::setprecision(4) << total
+           << std::setw(14) << total/std::max(fNofThreads, 1)
+           << std::setw(12) << ( fCalls[i] ? 1.e6*total/fCalls[i] : 0. )
+           << std::setw(10) << std::setprecision(3)
+           << ( threadsTime > 0. ? 100.*total/threadsTime : 0. ) << G4endl;
+  }
+  G4cout << "(the Stepping counters exclude ProcessHits: the counters do not overlap)"
+         << std::setprecision(6) << G4endl << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool ProfileCounters::WriteJson(const G4String& fileName, G4double wallTime) const
+{
+  std::ofstream output(fileName);
+  if ( ! output.is_open() ) return false;
+
+  output << "{\n  \"threads\": " << fNofThreads
+         << ",\n  \"wall_time_s\": " << wallTime
+         << ",\n  \"counters\": {";
+  for ( std::size_t i=0; i<kNofCounters; ++i ) {
+    output << ( i ? "," : "" ) << "\n    \"" << kCounterNames[i]
+           << "\": { \"calls\": " << fCalls[i]
+           << ", \"time_s\": " << ToSeconds(fTimes[i]) << " }";
+  }
+  output << "\n  }\n}\n";
+  return output.good();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
@@ -29,57 +29,319 @@
 /// \brief Implementation of the RunAction class
 
 #include "RunAction.hh"
+#include "EventAction.hh"
+#include "ColumnarWriter.hh"
+#include "DetectorConstruction.hh"
+#include "EventTracer.hh"
+#include "Logger.hh"
+#include "PrimaryGeneratorAction.hh"
 
+#include "G4AccumulableManager.hh"
 #include "G4AnalysisManager.hh"
+#include "G4GenericMessenger.hh"
 #include "G4Run.hh"
+#include "G4RunManager.hh"
 #include "G4SystemOfUnits.hh"
+#include "G4Threading.hh"
+
+namespace
+{
+
+// There is no run manager when the run actions are driven outside of
+// a run (see benchmarks/sdBenchmark.cc)
+const PrimaryGeneratorAction* GetGenerator()
+{
+  auto runManager = G4RunManager::GetRunManager();
+  return runManager ? static_cast<const PrimaryGeneratorAction*>(
+                        runManager->GetUserPrimaryGeneratorAction())
+                    : nullptr;
+}
+
+}
 
 namespace ED
 {
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-RunAction::RunAction()
+RunAction::RunAction(EventAction* eventAction)
+ : fEventAction(eventAction),
+   fSpectra("Spectra"),
+   fSpectrumEMax(1.*MeV),
+   fProfile("Profile"),
+   fNofSamples("NofSamples", 0.)
 {
+  fMessenger = new G4GenericMessenger(this, "/output/", "Output control");
+  fMessenger->DeclareProperty("format", fFileType,
+                              "Output file format (root, csv or lcol columnar binary)")
+    .SetCandidates("root csv lcol");
+  fMessenger->DeclareProperty("merge", fMergeNtuples,
+    "Merge the ntuples of the worker threads in one file;\n"
+    "if false, each worker writes events_t<N>.* (to be set before the first run)");
+  fMessenger->DeclareProperty("hits", fWriteHits,
+                              "Write the hits (ntuple or columnar file)");
+  fMessenger->DeclareProperty("spectra", fFillSpectra,
+                              "Accumulate the detectors spectra in spectra.lspc");
+  fMessenger->DeclareProperty("spectrumBins", fSpectrumNofBins,
+                              "Number of bins of the spectra");
+  fMessenger->DeclarePropertyWithUnit("spectrumEmax", "keV", fSpectrumEMax,
+                                      "Upper edge of the spectra");
+
+  fProfileMessenger = new G4GenericMessenger(this, "/profile/", "Hot paths profiling");
+  fProfileMessenger->DeclareMethod("enable", &RunAction::SetProfiling,
+    "Time the hot paths (primary generation, steps in the detectors,\n"
+    "SD and output) and print the counters at the end of the run");
+  fProfileMessenger->DeclareProperty("fileName", fProfileFileName,
+    "JSON file of the profile counters (empty: not written)");
+
+  // Register the spectra, the profile counters and the number of
+  // primaries samples to the accumulable manager
+  G4AccumulableManager::Instance()->RegisterAccumulable(fSpectra);
+  G4AccumulableManager::Instance()->RegisterAccumulable(fProfile);
+  G4AccumulableManager::Instance()->RegisterAccumulable(fNofSamples);
+  ProfileCounters::SetInstance(&fProfile);
+
   // Create analysis manager
   auto analysisManager = G4AnalysisManager::Instance();
   analysisManager->SetVerboseLevel(1);
-  analysisManager->SetNtupleMerging(true);
 
-  // Creating ntuple
+  // Creating ntuple: one row per event, the fired detectors and their
+  // energies (keV) are stored in vector columns filled by EventAction
   //
-  // ntuple id = 0
-  analysisManager->CreateNtuple("Events", "Events list");
-  analysisManager->CreateNtupleIColumn("EventID");   // column id = 0
-  analysisManager->CreateNtupleIColumn("Detector");   // column id = 1
-  analysisManager->CreateNtupleDColumn("Energy");    // column id = 2
-  analysisManager->FinishNtuple();
+  // ntuple id = 0 (booked on all threads, the master one receives
+  // the merged rows)
+  if ( fEventAction ) {
+    analysisManager->CreateNtuple("Events", "Events list");
+    analysisManager->CreateNtupleIColumn("EventID");   // column id = 0
+    analysisManager->CreateNtupleIColumn("Detector",
+                                         fEventAction->GetDetectorIDs());   // column id = 1
+    analysisManager->CreateNtupleDColumn("Energy",
+                                         fEventAction->GetEnergies());    // column id = 2
+    analysisManager->FinishNtuple();
+
+    // ntuple id = 1: one row per thread processing events, with its
+    // numbers of events and of primaries samples (which normalise the
+    // events with /generator/acceptance resample)
+    analysisManager->CreateNtuple("Run", "Run summary");
+    analysisManager->CreateNtupleIColumn("NofEvents");   // column id = 0
+    analysisManager->CreateNtupleDColumn("NofSamples");  // column id = 1
+    analysisManager->FinishNtuple();
+  }
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 RunAction::~RunAction()
-{}
+{
+  if ( ProfileCounters::Instance() == &fProfile ) {
+    ProfileCounters::SetInstance(nullptr);
+  }
+  delete fMessenger;
+  delete fProfileMessenger;
+}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-void RunAction::BeginOfRunAction(const G4Run* /*run*/)
+void RunAction::SetProfiling(G4bool enable)
 {
+#ifdef LAUE_PROFILING
+  ProfileCounters::SetEnabled(enable);
+#else
+  if ( enable ) {
+    G4Exception("RunAction::SetProfiling()", "laueDet0016", JustWarning,
+                "The profile counters are not compiled (LAUE_PROFILING CMake option).");
+  }
+#endif
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RunAction::BeginOfRunAction(const G4Run* run)
+{
+  // The messages of the run are written in a log file
+  // (opened before the workers start their run)
+  if ( IsMaster() && Logger::Instance() ) {
+    Logger::Instance()->OpenFile(run->GetRunID());
+  }
+  if ( IsMaster() && EventTracer::Instance() ) {
+    EventTracer::Instance()->StartRun(run->GetRunID());
+  }
+
+  G4AccumulableManager::Instance()->Reset();
+  auto generator = GetGenerator();
+  fFirstSample = generator ? generator->GetNofSamples() : 0.;
+  fRunStart = ProfileCounters::Clock::now();
+
+  // Online spectra of all the detectors channels
+  if ( fFillSpectra ) {
+    auto detector = static_cast<const DetectorConstruction*>(
+      G4RunManager::GetRunManager()->GetUserDetectorConstruction());
+    fSpectra.Configure(detector->GetChannelRanges(),
+                       fSpectrumNofBins, fSpectrumEMax);
+  }
+  if ( fEventAction ) {
+    fEventAction->SetSpectra(fFillSpectra ? &fSpectra : nullptr);
+    fEventAction->SetWriteHits(fWriteHits);
+  }
+
+  // Spectra only run: no per-hit output
+  if ( ! fWriteHits ) return;
+
+  // The master of the worker threads does not process events
+  auto isMasterOfWorkers = IsMaster() && G4Threading::IsMultithreadedApplication();
+
+  // Columnar output: each worker writes its own events_t<N>.lcol file
+  // with one row per hit
+  if ( fFileType == "lcol" ) {
+    if ( isMasterOfWorkers ) return;
+
+    G4String fileName = "events";
+    if ( G4Threading::IsWorkerThread() ) {
+      fileName += "_t" + std::to_string(G4Threading::G4GetThreadId());
+    }
+    fileName += ".lcol";
+    fColumnarWriter = new ColumnarWriter(fileName,
+      { lcol::MakeColumn("EventID", lcol::ColumnType::kInt32),
+        lcol::MakeColumn("Detector", lcol::ColumnType::kInt32),
+        lcol::MakeColumn("Energy", lcol::ColumnType::kFloat64) });
+    if ( ! fColumnarWriter->IsOpen() ) {
+      G4ExceptionDescription msg;
+      msg << "Cannot open " << fileName;
+      G4Exception("RunAction::BeginOfRunAction()", "laueDet0003",
+                  FatalException, msg);
+    }
+    fEventAction->SetColumnarWriter(fColumnarWriter);
+    return;
+  }
+
   // Get analysis manager
   auto analysisManager = G4AnalysisManager::Instance();
+  analysisManager->SetDefaultFileType(fFileType);
+  // Only ROOT ntuples can be merged by Geant4
+  analysisManager->SetNtupleMerging(fMergeNtuples && fFileType == "root");
+
+  // Without merging, the master has nothing to write
+  // and each worker writes its own events_t<N> file
+  if ( isMasterOfWorkers && ! fMergeNtuples ) return;
 
   // Open an output file
-  G4String fileName = "events.root";
+  G4String fileName = "events";
   analysisManager->OpenFile(fileName);
   G4cout << "Using " << analysisManager->GetType() << G4endl;
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-void RunAction::EndOfRunAction(const G4Run* /*run*/)
+void RunAction::EndOfRunAction(const G4Run* run)
 {
-  // Close and write root file 
+  // The workers have finished their run
+  if ( IsMaster() && Logger::Instance() ) {
+    Logger::Instance()->CloseFile();
+  }
+  if ( EventTracer::IsEnabled() ) {
+    EventTracer::Add("EventLoop", fRunStart, EventTracer::Now());
+  }
+
+  // Primaries samples of this thread
+  auto generator = GetGenerator();
+  if ( generator ) fNofSamples += generator->GetNofSamples() - fFirstSample;
+
+  // Close the output files
+  {
+    LAUE_PROFILE_SCOPE(ProfileCounter::kOutputWrite);
+    TraceScope trace("OutputWrite");
+    CloseOutput(run);
+  }
+
+  // Merge the accumulables of the workers and write them from the master
+  {
+    TraceScope trace("Merge");
+    G4AccumulableManager::Instance()->Merge();
+  }
+  if ( IsMaster() ) {
+    TraceScope trace("ResultsWrite");
+    WriteResults(run);
+  }
+
+  // The trace is written last, with the spans of the master
+  if ( IsMaster() && EventTracer::Instance() ) {
+    EventTracer::Instance()->EndRun();
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RunAction::WriteResults(const G4Run* run)
+{
+  // The number of primaries samples normalises the events
+  if ( fNofSamples.GetValue() != run->GetNumberOfEvent() ) {
+    G4cout << ">>> " << run->GetNumberOfEvent() << " events from "
+           << fNofSamples.GetValue() << " primaries samples (acceptance "
+           << run->GetNumberOfEvent()/fNofSamples.GetValue() << ")" << G4endl;
+  }
+
+  if ( fFillSpectra ) {
+    G4String fileName = "spectra.lspc";
+    if ( fSpectra.Write(fileName, (G4long)fNofSamples.GetValue()) ) {
+      G4cout << ">>> Spectra written in " << fileName << G4endl;
+    }
+    else {
+      G4ExceptionDescription msg;
+      msg << "Error writing " << fileName;
+      G4Exception("RunAction::EndOfRunAction()", "laueDet0006",
+                  JustWarning, msg);
+    }
+  }
+
+  if ( ProfileCounters::IsEnabled() ) {
+    std::chrono::duration<G4double> wallTime
+      = ProfileCounters::Clock::now() - fRunStart;
+    fProfile.Print(wallTime.count());
+    if ( ! fProfileFileName.empty() &&
+         ! fProfile.WriteJson(fProfileFileName, wallTime.count()) ) {
+      G4ExceptionDescription msg;
+      msg << "Error writing " << fProfileFileName;
+      G4Exception("RunAction::EndOfRunAction()", "laueDet0015",
+                  JustWarning, msg);
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RunAction::CloseOutput(const G4Run* run)
+{
+  if ( fColumnarWriter ) {
+    fColumnarWriter->SetMetadata("run_id", std::to_string(run->GetRunID()));
+    fColumnarWriter->SetMetadata("thread_id",
+                                 std::to_string(G4Threading::G4GetThreadId()));
+    fColumnarWriter->SetMetadata("nof_events",
+                                 std::to_string(run->GetNumberOfEvent()));
+    fColumnarWriter->SetMetadata("energy_unit", "keV");
+    fColumnarWriter->SetMetadata("nof_samples",
+                                 std::to_string((G4long)fNofSamples.GetValue()));
+    if ( ! fColumnarWriter->Close() ) {
+      G4ExceptionDescription msg;
+      msg << "Error writing " << fColumnarWriter->GetFileName();
+      G4Exception("RunAction::EndOfRunAction()", "laueDet0004",
+                  JustWarning, msg);
+    }
+    G4cout << ">>> " << fColumnarWriter->GetNofRows() << " hits written in "
+           << fColumnarWriter->GetFileName() << G4endl;
+    fEventAction->SetColumnarWriter(nullptr);
+    delete fColumnarWriter;
+    fColumnarWriter = nullptr;
+    return;
+  }
+
+  // Close and write root file
   G4AnalysisManager* analysisManager = G4AnalysisManager::Instance();
+  if ( ! analysisManager->IsOpenFile() ) return;
+  if ( ! ( IsMaster() && G4Threading::IsMultithreadedApplication() ) ) {
+    analysisManager->FillNtupleIColumn(1, 0, run->GetNumberOfEvent());
+    analysisManager->FillNtupleDColumn(1, 1, fNofSamples.GetValue());
+    analysisManager->AddNtupleRow(1);
+  }
   analysisManager->Write();
   analysisManager->CloseFile();
 }
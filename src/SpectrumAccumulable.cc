@@ -0,0 +1,148 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+// $Id$
+//
+/// \file SpectrumAccumulable.cc
+/// \brief Implementation of the SpectrumAccumulable class
+
+#include "SpectrumAccumulable.hh"
+#include "SpectrumFile.hh"
+
+#include "G4SystemOfUnits.hh"
+
+#include <algorithm>
+#include <fstream>
+#include <limits>
+
+namespace ED
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+SpectrumAccumulable::SpectrumAccumulable(const G4String& name)
+ : G4VAccumulable(name)
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void SpectrumAccumulable::Configure(const std::vector<ChannelRange>& channels,
+                                    G4int nofBins, G4double eMax)
+{
+  fChannels = channels;
+  fFirstRows.clear();
+  G4int nofRows = 0;
+  for ( const auto& range : fChannels ) {
+    fFirstRows.push_back(nofRows);
+    nofRows += range.count;
+  }
+  fNofBins = nofBins;
+  fEMax = eMax;
+  fInvBinWidth = fNofBins/fEMax;
+  fCounts.assign(std::size_t(nofRows)*fNofBins, 0);
+  fNofEvents = 0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4long* SpectrumAccumulable::FindSpectrum(G4int channel)
+{
+  for ( std::size_t i=0; i<fChannels.size(); ++i ) {
+    if ( fChannels[i].Contains(channel) ) {
+      auto row = fFirstRows[i] + channel - fChannels[i].first;
+      return fCounts.data() + std::size_t(row)*fNofBins;
+    }
+  }
+  return nullptr;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void SpectrumAccumulable::Merge(const G4VAccumulable& other)
+{
+  const auto& otherSpectra = static_cast<const SpectrumAccumulable&>(other);
+  if ( otherSpectra.fCounts.size() != fCounts.size() ) {
+    G4Exception("SpectrumAccumulable::Merge()", "laueDet0005",
+                JustWarning, "Spectra with different binning are not merged.");
+    return;
+  }
+  for ( std::size_t i=0; i<fCounts.size(); ++i ) {
+    fCounts[i] += otherSpectra.fCounts[i];
+  }
+  fNofEvents += otherSpectra.fNofEvents;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void SpectrumAccumulable::Reset()
+{
+  std::fill(fCounts.begin(), fCounts.end(), 0);
+  fNofEvents = 0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool SpectrumAccumulable::Write(const G4String& fileName, G4long nofSamples) const
+{
+  std::ofstream output(fileName, std::ios::binary);
+  if ( ! output.is_open() ) return false;
+
+  // The counts are written on 4 bytes when possible
+  G4long maxCount = 0;
+  for ( auto count : fCounts ) maxCount = std::max(maxCount, count);
+  G4bool wide = maxCount > std::numeric_limits<uint32_t>::max();
+
+  lspc::SpectrumFileHeader header {};
+  std::memcpy(header.magic, lspc::kMagic, sizeof(header.magic));
+  header.nofChannels = fCounts.size()/std::max(fNofBins, 1);
+  header.nofBins = fNofBins;
+  header.countWidth = wide ? 8 : 4;
+  header.eMin = 0.;
+  header.eMax = fEMax/keV;
+  header.nofEvents = fNofEvents;
+  header.nofSamples = nofSamples;
+  output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+  std::vector<int32_t> detectorIDs;
+  for ( const auto& range : fChannels ) {
+    for ( G4int i=0; i<range.count; ++i ) detectorIDs.push_back(range.first + i);
+  }
+  output.write(reinterpret_cast<const char*>(detectorIDs.data()),
+               detectorIDs.size()*sizeof(int32_t));
+
+  if ( wide ) {
+    std::vector<uint64_t> counts(fCounts.begin(), fCounts.end());
+    output.write(reinterpret_cast<const char*>(counts.data()), counts.size()*8);
+  }
+  else {
+    std::vector<uint32_t> counts(fCounts.begin(), fCounts.end());
+    output.write(reinterpret_cast<const char*>(counts.data()), counts.size()*4);
+  }
+  return output.good();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
@@ -0,0 +1,100 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+// $Id$
+//
+/// \file StackingAction.cc
+/// \brief Implementation of the StackingAction class
+
+#include "StackingAction.hh"
+#include "EmCalorimeterSD.hh"
+
+#include "G4GenericMessenger.hh"
+#include "G4Track.hh"
+#include "G4Electron.hh"
+#include "G4LogicalVolume.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4LossTableManager.hh"
+#include "G4SystemOfUnits.hh"
+
+namespace ED
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+StackingAction::StackingAction()
+ : fMaxRange(1.*mm)
+{
+  fMessenger = new G4GenericMessenger(this, "/stacking/", "Stacking control");
+  fMessenger->DeclareProperty("localDeposit", fLocalDeposit,
+    "Deposit the short range secondary electrons in their pixel without tracking them");
+  fMessenger->DeclarePropertyWithUnit("maxRange", "mm", fMaxRange,
+    "Maximum range of the electrons deposited locally (0: not used)");
+  fMessenger->DeclarePropertyWithUnit("maxEnergy", "keV", fMaxEnergy,
+    "Maximum kinetic energy of the electrons deposited locally (0: not used)");
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+StackingAction::~StackingAction()
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4ClassificationOfNewTrack
+StackingAction::ClassifyNewTrack(const G4Track* track)
+{
+  if ( ! fLocalDeposit ) return fUrgent;
+
+  // Only the secondary electrons created in a sensitive volume
+  if ( track->GetParentID() == 0 ||
+       track->GetDefinition() != G4Electron::Definition() ) return fUrgent;
+  auto volume = track->GetVolume();
+  if ( ! volume ) return fUrgent;
+  auto logicalVolume = volume->GetLogicalVolume();
+  auto sd = dynamic_cast<EmCalorimeterSD*>(logicalVolume->GetSensitiveDetector());
+  if ( ! sd ) return fUrgent;
+
+  // The range is read from the tables of the energy loss processes
+  // (the range with the production cut of the volume, an upper bound
+  // of the distance travelled)
+  auto energy = track->GetKineticEnergy();
+  G4bool local = ( energy < fMaxEnergy );
+  if ( ! local && fMaxRange > 0. ) {
+    local = ( G4LossTableManager::Instance()->GetRange(
+                track->GetDefinition(), energy,
+                logicalVolume->GetMaterialCutsCouple()) < fMaxRange );
+  }
+  if ( ! local ) return fUrgent;
+
+  sd->AddDeposit(track->GetTouchable(), track->GetPosition(), energy);
+  return fKill;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
@@ -0,0 +1,113 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+// $Id$
+//
+/// \file SteppingAction.cc
+/// \brief Implementation of the SteppingAction class
+
+#include "SteppingAction.hh"
+
+#include "G4GenericMessenger.hh"
+#include "G4Step.hh"
+#include "G4Track.hh"
+#include "G4LogicalVolume.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4VSensitiveDetector.hh"
+
+namespace ED
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+SteppingAction::SteppingAction()
+{
+  fMessenger = new G4GenericMessenger(this, "/stepping/", "Stepping control");
+  fMessenger->DeclareProperty("killEscaping", fKillEscaping,
+    "Kill the particles leaving a detector which cannot reach another one");
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+SteppingAction::~SteppingAction()
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void SteppingAction::UserSteppingAction(const G4Step* step)
+{
+  if ( fKillEscaping ) KillEscaping(step);
+
+#ifdef LAUE_PROFILING
+  if ( ! ProfileCounters::IsEnabled() ) return;
+  auto counters = ProfileCounters::Instance();
+  if ( ! counters ) return;
+
+  auto volume = step->GetPreStepPoint()->GetPhysicalVolume();
+  auto sd = volume ? volume->GetLogicalVolume()->GetSensitiveDetector() : nullptr;
+  counters->AddStep(sd ? GetCounter(sd) : ProfileCounter::kSteppingOther);
+#endif
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void SteppingAction::KillEscaping(const G4Step* step)
+{
+  // Only the steps ending on the boundary of a detector
+  // and going in the world (the volume without mother)
+  auto postStepPoint = step->GetPostStepPoint();
+  if ( postStepPoint->GetStepStatus() != fGeomBoundary ) return;
+  auto volume = postStepPoint->GetPhysicalVolume();
+  if ( ! volume || volume->GetMotherLogical() ) return;
+
+  if ( ! fAcceptanceFilter.IsAccepted(postStepPoint->GetPosition(),
+                                      postStepPoint->GetMomentumDirection()) ) {
+    step->GetTrack()->SetTrackStatus(fStopAndKill);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+ProfileCounter SteppingAction::GetCounter(const G4VSensitiveDetector* sd)
+{
+  for ( const auto& [knownSD, counter] : fCounters ) {
+    if ( knownSD == sd ) return counter;
+  }
+
+  // The SDs are named after their detector (see DetectorConstruction)
+  auto counter = ProfileCounter::kSteppingOther;
+  const auto& name = sd->GetName();
+  if      ( name.find("detectorA") == 0 ) counter = ProfileCounter::kSteppingA;
+  else if ( name.find("detectorB") == 0 ) counter = ProfileCounter::kSteppingB;
+  else if ( name.find("detectorC") == 0 ) counter = ProfileCounter::kSteppingC;
+  fCounters.emplace_back(sd, counter);
+  return counter;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
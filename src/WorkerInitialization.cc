@@ -0,0 +1,184 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+// $Id$
+//
+/// \file WorkerInitialization.cc
+/// \brief Implementation of the WorkerInitialization class
+
+#include "WorkerInitialization.hh"
+#include "Logger.hh"
+
+#include "G4GenericMessenger.hh"
+#include "G4RunManager.hh"
+#include "G4TaskRunManager.hh"
+#include "G4Threading.hh"
+
+#include <fstream>
+#include <sstream>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace
+{
+
+// Parse a sysfs cpu list ("0-7,16-23")
+std::vector<G4int> ParseCpuList(const std::string& list)
+{
+  std::vector<G4int> cpus;
+  std::istringstream input(list);
+  std::string range;
+  while ( std::getline(input, range, ',') ) {
+    if ( range.empty() ) continue;
+    auto dash = range.find('-');
+    auto first = std::stoi(range.substr(0, dash));
+    auto last = ( dash == std::string::npos ) ? first : std::stoi(range.substr(dash + 1));
+    for ( auto cpu = first; cpu <= last; ++cpu ) cpus.push_back(cpu);
+  }
+  return cpus;
+}
+
+}
+
+namespace ED
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+WorkerInitialization::WorkerInitialization()
+{
+  fMessenger = new G4GenericMessenger(this, "/threads/", "Worker threads setup");
+  fMessenger->DeclareProperty("affinity", fAffinity,
+    "Pin each worker thread to one core (core) or to the cores\n"
+    "of one NUMA node (numa); to be set before the first run")
+    .SetCandidates("none core numa")
+    .command->SetToBeBroadcasted(false);
+  fMessenger->DeclareMethod("grainsize", &WorkerInitialization::SetGrainsize,
+    "Number of events per task (tasking run manager only)")
+    .command->SetToBeBroadcasted(false);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+WorkerInitialization::~WorkerInitialization()
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void WorkerInitialization::SetGrainsize(G4int grainsize)
+{
+  auto runManager = dynamic_cast<G4TaskRunManager*>(G4RunManager::GetRunManager());
+  if ( ! runManager ) {
+    G4Exception("WorkerInitialization::SetGrainsize()", "laueDet0013",
+                JustWarning, "The grain size is used only by the tasking run manager.");
+    return;
+  }
+  runManager->SetGrainsize(grainsize);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void WorkerInitialization::WorkerStart() const
+{
+  if ( fAffinity == "none" ) return;
+
+#ifdef __linux__
+  auto nodes = GetNodesCores();
+  if ( nodes.empty() ) return;
+
+  // core: the allowed cores in turn, node after node;
+  // numa: the nodes in turn
+  std::vector<G4int> cores;
+  auto threadID = G4Threading::G4GetThreadId();
+  if ( fAffinity == "numa" ) {
+    cores = nodes[threadID % nodes.size()];
+  }
+  else {
+    std::vector<G4int> allCores;
+    for ( const auto& node : nodes ) {
+      allCores.insert(allCores.end(), node.begin(), node.end());
+    }
+    cores.push_back(allCores[threadID % allCores.size()]);
+  }
+
+  cpu_set_t cpuSet;
+  CPU_ZERO(&cpuSet);
+  for ( auto core : cores ) CPU_SET(core, &cpuSet);
+  if ( pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet) != 0 ) {
+    G4Exception("WorkerInitialization::WorkerStart()", "laueDet0014",
+                JustWarning, "Cannot set the affinity of the worker thread.");
+    return;
+  }
+  LAUE_LOG_INFO("Worker thread " << threadID << " pinned to " << cores.size()
+                << " core(s) from the core " << cores.front());
+#else
+  G4Exception("WorkerInitialization::WorkerStart()", "laueDet0014",
+              JustWarning, "The threads affinity is supported only on Linux.");
+#endif
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+std::vector<std::vector<G4int>> WorkerInitialization::GetNodesCores() const
+{
+  std::vector<std::vector<G4int>> nodes;
+#ifdef __linux__
+  // The cores allowed to the process (the worker inherits them)
+  cpu_set_t allowed;
+  CPU_ZERO(&allowed);
+  if ( sched_getaffinity(0, sizeof(allowed), &allowed) != 0 ) return nodes;
+
+  // The NUMA nodes from sysfs; a single node if not available
+  for ( G4int i=0; ; ++i ) {
+    std::ifstream cpuList(
+      "/sys/devices/system/node/node" + std::to_string(i) + "/cpulist");
+    if ( ! cpuList.is_open() ) break;
+    std::string list;
+    std::getline(cpuList, list);
+    std::vector<G4int> cores;
+    for ( auto cpu : ParseCpuList(list) ) {
+      if ( cpu < CPU_SETSIZE && CPU_ISSET(cpu, &allowed) ) cores.push_back(cpu);
+    }
+    if ( ! cores.empty() ) nodes.push_back(cores);
+  }
+  if ( nodes.empty() ) {
+    std::vector<G4int> cores;
+    for ( G4int cpu=0; cpu<CPU_SETSIZE; ++cpu ) {
+      if ( CPU_ISSET(cpu, &allowed) ) cores.push_back(cpu);
+    }
+    if ( ! cores.empty() ) nodes.push_back(cores);
+  }
+#endif
+  return nodes;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
@@ -0,0 +1,194 @@
+/// \file compareSpectra.cc
+/// \brief Comparison of two laueDet spectra files
+///
+/// Validation of the approximations which change the tracking (such as
+/// the local deposit of the electrons, /stacking/localDeposit): the same
+/// run is made with and without the approximation and the spectra.lspc
+/// files are compared. For each detector (A, B, C, from the first digit
+/// of the detector IDs), the tool prints the hits per primaries sample
+/// (per event without the acceptance resampling) and the mean energy of
+/// both files, and compares the shapes of
+///  - the energy spectrum summed over the pixels (chi2 per degree of
+///    freedom of the two histograms and Kolmogorov distance),
+///  - the number of hits of each pixel (chi2 per degree of freedom).
+/// With -c, the exit code is 2 if a chi2 per degree of freedom is above
+/// the given value.
+
+#include "SpectrumFile.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+void PrintUsage()
+{
+  std::cerr << "USAGE" << std::endl;
+  std::cerr << "compareSpectra [-c maxChi2] reference.lspc test.lspc"
+            << std::endl;
+  std::cerr << "  -c  fail if a chi2/ndf is above maxChi2" << std::endl;
+}
+
+// The histograms of one detector
+struct Detector
+{
+  std::vector<double> energy;   // summed over the pixels
+  std::vector<double> pixels;   // hits of each pixel
+  double nofHits = 0.;
+  double sumEnergy = 0.;
+};
+
+std::map<char, Detector> Summarize(const ED::lspc::Spectra& spectra)
+{
+  std::map<char, Detector> detectors;
+  const auto& header = spectra.header;
+  auto binWidth = spectra.GetBinWidth();
+  for ( std::size_t channel=0; channel<header.nofChannels; ++channel ) {
+    auto id = std::to_string(spectra.detectorIDs[channel]);
+    auto& detector = detectors[char('A' + (id[0] - '1'))];
+    detector.energy.resize(header.nofBins, 0.);
+    auto spectrum = spectra.GetSpectrum(channel);
+    double hits = 0.;
+    for ( std::size_t bin=0; bin<header.nofBins; ++bin ) {
+      auto count = double(spectrum[bin]);
+      detector.energy[bin] += count;
+      detector.sumEnergy += count*(header.eMin + (bin + 0.5)*binWidth);
+      hits += count;
+    }
+    detector.pixels.push_back(hits);
+    detector.nofHits += hits;
+  }
+  return detectors;
+}
+
+// Number of primaries samples which normalises the spectra (the number
+// of events if the file has none)
+double GetNofSamples(const ED::lspc::SpectrumFileHeader& header)
+{
+  auto samples = header.nofSamples ? header.nofSamples : header.nofEvents;
+  return double(std::max<uint64_t>(samples, 1));
+}
+
+// Chi2 per degree of freedom of the shapes of two histograms
+// with different numbers of entries
+double Chi2(const std::vector<double>& reference,
+            const std::vector<double>& test)
+{
+  double n1 = 0.;
+  double n2 = 0.;
+  for ( auto count : reference ) n1 += count;
+  for ( auto count : test ) n2 += count;
+  if ( n1 == 0. || n2 == 0. ) return 0.;
+
+  double chi2 = 0.;
+  int ndf = -1;
+  auto r12 = std::sqrt(n2/n1);
+  for ( std::size_t i=0; i<reference.size(); ++i ) {
+    auto sum = reference[i] + test[i];
+    if ( sum == 0. ) continue;
+    auto diff = r12*reference[i] - test[i]/r12;
+    chi2 += diff*diff/sum;
+    ++ndf;
+  }
+  return ( ndf > 0 ) ? chi2/ndf : 0.;
+}
+
+// Maximum distance between the normalised cumulative histograms
+double Kolmogorov(const std::vector<double>& reference,
+                  const std::vector<double>& test)
+{
+  double n1 = 0.;
+  double n2 = 0.;
+  for ( auto count : reference ) n1 += count;
+  for ( auto count : test ) n2 += count;
+  if ( n1 == 0. || n2 == 0. ) return 0.;
+
+  double c1 = 0.;
+  double c2 = 0.;
+  double distance = 0.;
+  for ( std::size_t i=0; i<reference.size(); ++i ) {
+    c1 += reference[i]/n1;
+    c2 += test[i]/n2;
+    distance = std::max(distance, std::abs(c1 - c2));
+  }
+  return distance;
+}
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+int main(int argc, char** argv)
+{
+  std::vector<std::string> inputs;
+  double maxChi2 = 0.;
+  for ( int i=1; i<argc; ++i ) {
+    std::string arg = argv[i];
+    if ( arg == "-c" && i+1 < argc ) maxChi2 = std::atof(argv[++i]);
+    else if ( ! arg.empty() && arg[0] != '-' ) inputs.push_back(arg);
+    else {
+      PrintUsage();
+      return 1;
+    }
+  }
+  if ( inputs.size() != 2 ) {
+    PrintUsage();
+    return 1;
+  }
+
+  ED::lspc::Spectra reference;
+  ED::lspc::Spectra test;
+  try {
+    reference = ED::lspc::ReadSpectra(inputs[0]);
+    test = ED::lspc::ReadSpectra(inputs[1]);
+  }
+  catch ( const std::exception& e ) {
+    std::cerr << "compareSpectra: " << e.what() << std::endl;
+    return 1;
+  }
+  if ( reference.header.nofBins != test.header.nofBins ||
+       reference.header.eMin != test.header.eMin ||
+       reference.header.eMax != test.header.eMax ||
+       reference.detectorIDs != test.detectorIDs ) {
+    std::cerr << "compareSpectra: the files have different detectors or binnings"
+              << std::endl;
+    return 1;
+  }
+
+  auto referenceSamples = GetNofSamples(reference.header);
+  auto testSamples = GetNofSamples(test.header);
+  std::printf("%-8s %21s %21s %12s %10s %12s\n", "detector",
+              "hits/sample(ref/test)", "mean keV (ref/test)",
+              "energy chi2", "energy KS", "pixels chi2");
+
+  auto referenceDetectors = Summarize(reference);
+  auto testDetectors = Summarize(test);
+  bool accepted = true;
+  for ( const auto& [name, detector] : referenceDetectors ) {
+    const auto& other = testDetectors[name];
+    auto energyChi2 = Chi2(detector.energy, other.energy);
+    auto pixelsChi2 = Chi2(detector.pixels, other.pixels);
+    std::printf("%-8c %10.4f %10.4f %10.1f %10.1f %12.3f %10.4f %12.3f\n", name,
+                detector.nofHits/referenceSamples, other.nofHits/testSamples,
+                detector.nofHits ? detector.sumEnergy/detector.nofHits : 0.,
+                other.nofHits ? other.sumEnergy/other.nofHits : 0.,
+                energyChi2, Kolmogorov(detector.energy, other.energy),
+                pixelsChi2);
+    if ( maxChi2 > 0. && ( energyChi2 > maxChi2 || pixelsChi2 > maxChi2 ) ) {
+      accepted = false;
+    }
+  }
+
+  if ( ! accepted ) {
+    std::cerr << "compareSpectra: chi2/ndf above " << maxChi2 << std::endl;
+    return 2;
+  }
+  return 0;
+}
@@ -0,0 +1,392 @@
+/// \file laueMerge.cc
+/// \brief Offline merger of the per-thread output files of laueDet
+///
+/// When laueDet runs with /output/merge false, each worker thread writes
+/// its own file. This tool merges the shards in parallel:
+///  - csv shards (events_nt_Events_t<N>.csv) are read by a pool of threads
+///    and concatenated, or merged in event ID order with -s;
+///  - lcol columnar shards (events_t<N>.lcol) are memory mapped and
+///    their chunks are rewritten in one file, in event ID order with -s;
+///  - root shards (events_t<N>.root) are merged with ROOT's parallel
+///    hadd (hadd -j), which must be in the PATH.
+
+#include "ColumnarReader.hh"
+#include "ColumnarWriter.hh"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <queue>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+namespace
+{
+
+void PrintUsage()
+{
+  std::cerr << "USAGE" << std::endl;
+  std::cerr << "laueMerge [-s] [-j nThreads] -o output shard1 [shard2 ...]"
+            << std::endl;
+  std::cerr << "  -s  sort the rows by event ID (csv and lcol)" << std::endl;
+  std::cerr << "  -j  number of threads (default: hardware concurrency)"
+            << std::endl;
+  std::cerr << std::endl;
+}
+
+bool HasExtension(const std::string& fileName, const std::string& extension)
+{
+  return fileName.size() >= extension.size()
+    && fileName.compare(fileName.size() - extension.size(),
+                        extension.size(), extension) == 0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+struct CsvShard
+{
+  std::vector<std::string> header;  // the '#' lines
+  std::vector<std::string> rows;
+  std::vector<long> eventIDs;       // first column of each row
+  std::string error;
+};
+
+void ReadCsvShard(const std::string& fileName, bool sort, CsvShard& shard)
+{
+  std::ifstream input(fileName);
+  if ( ! input.is_open() ) {
+    shard.error = "cannot open " + fileName;
+    return;
+  }
+
+  std::string line;
+  while ( std::getline(input, line) ) {
+    if ( line.empty() ) continue;
+    if ( line[0] == '#' ) {
+      shard.header.push_back(line);
+      continue;
+    }
+    shard.eventIDs.push_back(std::strtol(line.c_str(), nullptr, 10));
+    shard.rows.push_back(std::move(line));
+  }
+
+  // The events of a worker are processed in increasing order,
+  // but do not rely on it
+  if ( sort && ! std::is_sorted(shard.eventIDs.begin(), shard.eventIDs.end()) ) {
+    std::vector<std::size_t> order(shard.rows.size());
+    for ( std::size_t i=0; i<order.size(); ++i ) order[i] = i;
+    std::stable_sort(order.begin(), order.end(),
+      [&shard](std::size_t a, std::size_t b)
+      { return shard.eventIDs[a] < shard.eventIDs[b]; });
+
+    std::vector<std::string> rows(order.size());
+    std::vector<long> eventIDs(order.size());
+    for ( std::size_t i=0; i<order.size(); ++i ) {
+      rows[i] = std::move(shard.rows[order[i]]);
+      eventIDs[i] = shard.eventIDs[order[i]];
+    }
+    shard.rows.swap(rows);
+    shard.eventIDs.swap(eventIDs);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+int MergeCsv(const std::string& output, const std::vector<std::string>& inputs,
+             bool sort, unsigned int nofThreads)
+{
+  // Read the shards in parallel
+  std::vector<CsvShard> shards(inputs.size());
+  std::atomic<std::size_t> next(0);
+  auto worker = [&]() {
+    for ( auto i = next++; i < inputs.size(); i = next++ ) {
+      ReadCsvShard(inputs[i], sort, shards[i]);
+    }
+  };
+  std::vector<std::thread> threads;
+  for ( unsigned int i=0; i<std::min<std::size_t>(nofThreads, inputs.size()); ++i ) {
+    threads.emplace_back(worker);
+  }
+  for ( auto& thread : threads ) thread.join();
+
+  std::size_t nofRows = 0;
+  for ( std::size_t i=0; i<shards.size(); ++i ) {
+    if ( ! shards[i].error.empty() ) {
+      std::cerr << "laueMerge: " << shards[i].error << std::endl;
+      return 1;
+    }
+    if ( shards[i].header != shards[0].header ) {
+      std::cerr << "laueMerge: " << inputs[i]
+                << " has a different schema than " << inputs[0] << std::endl;
+      return 1;
+    }
+    nofRows += shards[i].rows.size();
+  }
+
+  std::ofstream out(output);
+  if ( ! out.is_open() ) {
+    std::cerr << "laueMerge: cannot open " << output << std::endl;
+    return 1;
+  }
+  for ( const auto& line : shards[0].header ) out << line << '\n';
+
+  if ( ! sort ) {
+    for ( const auto& shard : shards ) {
+      for ( const auto& row : shard.rows ) out << row << '\n';
+    }
+  }
+  else {
+    // k-way merge of the sorted shards
+    using Entry = std::tuple<long, std::size_t, std::size_t>; // event, shard, row
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> heap;
+    for ( std::size_t i=0; i<shards.size(); ++i ) {
+      if ( ! shards[i].rows.empty() ) heap.emplace(shards[i].eventIDs[0], i, 0);
+    }
+    while ( ! heap.empty() ) {
+      auto [eventID, shard, row] = heap.top();
+      heap.pop();
+      out << shards[shard].rows[row] << '\n';
+      if ( ++row < shards[shard].rows.size() ) {
+        heap.emplace(shards[shard].eventIDs[row], shard, row);
+      }
+    }
+  }
+
+  std::cout << "laueMerge: " << nofRows << " rows from " << inputs.size()
+            << " shards written to " << output << std::endl;
+  return out.good() ? 0 : 1;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+struct LcolShard
+{
+  std::unique_ptr<ED::lcol::Reader> reader;
+  // Event IDs of all rows and, if they are not sorted, the row order
+  std::vector<int64_t> eventIDs;
+  std::vector<uint64_t> order;
+  std::string error;
+};
+
+int64_t EventIDAt(const ED::lcol::Reader& reader, std::size_t chunk,
+                  std::size_t row)
+{
+  if ( reader.GetColumnDescriptor(0).type == ED::lcol::ColumnType::kInt64 ) {
+    return reader.GetColumn<int64_t>(chunk, 0)[row];
+  }
+  return reader.GetColumn<int32_t>(chunk, 0)[row];
+}
+
+void ReadLcolShard(const std::string& fileName, bool sort, LcolShard& shard)
+{
+  try {
+    shard.reader.reset(new ED::lcol::Reader(fileName));
+  }
+  catch ( const std::exception& e ) {
+    shard.error = e.what();
+    return;
+  }
+  if ( ! sort ) return;
+
+  const auto& reader = *shard.reader;
+  shard.eventIDs.reserve(reader.GetNofRows());
+  for ( std::size_t chunk=0; chunk<reader.GetNofChunks(); ++chunk ) {
+    for ( std::size_t row=0; row<reader.GetChunk(chunk).nofRows; ++row ) {
+      shard.eventIDs.push_back(EventIDAt(reader, chunk, row));
+    }
+  }
+  if ( ! std::is_sorted(shard.eventIDs.begin(), shard.eventIDs.end()) ) {
+    shard.order.resize(shard.eventIDs.size());
+    for ( std::size_t i=0; i<shard.order.size(); ++i ) shard.order[i] = i;
+    std::stable_sort(shard.order.begin(), shard.order.end(),
+      [&shard](uint64_t a, uint64_t b)
+      { return shard.eventIDs[a] < shard.eventIDs[b]; });
+  }
+}
+
+int MergeLcol(const std::string& output, const std::vector<std::string>& inputs,
+              bool sort, unsigned int nofThreads)
+{
+  // Map the shards (and compute the sort order) in parallel
+  std::vector<LcolShard> shards(inputs.size());
+  std::atomic<std::size_t> next(0);
+  auto worker = [&]() {
+    for ( auto i = next++; i < inputs.size(); i = next++ ) {
+      ReadLcolShard(inputs[i], sort, shards[i]);
+    }
+  };
+  std::vector<std::thread> threads;
+  for ( unsigned int i=0; i<std::min<std::size_t>(nofThreads, inputs.size()); ++i ) {
+    threads.emplace_back(worker);
+  }
+  for ( auto& thread : threads ) thread.join();
+
+  // The counts of the run are the sums of the shards counts
+  std::map<std::string, long> counts = { { "nof_events", 0 }, { "nof_samples", 0 } };
+  for ( std::size_t i=0; i<shards.size(); ++i ) {
+    if ( ! shards[i].error.empty() ) {
+      std::cerr << "laueMerge: " << shards[i].error << std::endl;
+      return 1;
+    }
+    const auto& reader = *shards[i].reader;
+    const auto& first = *shards[0].reader;
+    bool sameSchema = reader.GetNofColumns() == first.GetNofColumns();
+    for ( std::size_t j=0; sameSchema && j<reader.GetNofColumns(); ++j ) {
+      sameSchema = std::memcmp(&reader.GetColumnDescriptor(j),
+                               &first.GetColumnDescriptor(j),
+                               sizeof(ED::lcol::ColumnDescriptor)) == 0;
+    }
+    if ( ! sameSchema ) {
+      std::cerr << "laueMerge: " << inputs[i]
+                << " has a different schema than " << inputs[0] << std::endl;
+      return 1;
+    }
+    for ( auto& count : counts ) {
+      auto it = reader.GetMetadata().find(count.first);
+      if ( it != reader.GetMetadata().end() ) count.second += std::stol(it->second);
+    }
+  }
+
+  const auto& first = *shards[0].reader;
+  std::vector<ED::lcol::ColumnDescriptor> columns;
+  for ( std::size_t j=0; j<first.GetNofColumns(); ++j ) {
+    columns.push_back(first.GetColumnDescriptor(j));
+  }
+  ED::ColumnarWriter writer(output, columns);
+  if ( ! writer.IsOpen() ) {
+    std::cerr << "laueMerge: cannot open " << output << std::endl;
+    return 1;
+  }
+  // The keys of the whole run are taken from the first shard, the thread
+  // ID of the shards is dropped
+  for ( const auto& entry : first.GetMetadata() ) {
+    if ( entry.first == "thread_id" || counts.count(entry.first) ) continue;
+    writer.SetMetadata(entry.first, entry.second);
+  }
+  for ( const auto& count : counts ) {
+    if ( first.GetMetadata().count(count.first) ) {
+      writer.SetMetadata(count.first, std::to_string(count.second));
+    }
+  }
+  writer.SetMetadata("merged_shards", std::to_string(inputs.size()));
+
+  // Location (chunk, row) of the rows of each shard
+  std::vector<std::vector<std::pair<uint32_t, uint32_t>>> rows(shards.size());
+  for ( std::size_t i=0; i<shards.size(); ++i ) {
+    const auto& reader = *shards[i].reader;
+    rows[i].reserve(reader.GetNofRows());
+    for ( std::size_t chunk=0; chunk<reader.GetNofChunks(); ++chunk ) {
+      for ( std::size_t row=0; row<reader.GetChunk(chunk).nofRows; ++row ) {
+        rows[i].emplace_back(chunk, row);
+      }
+    }
+  }
+  std::vector<const void*> values(columns.size());
+  auto addRow = [&](std::size_t shard, uint64_t index) {
+    if ( ! shards[shard].order.empty() ) index = shards[shard].order[index];
+    auto [chunk, row] = rows[shard][index];
+    const auto& reader = *shards[shard].reader;
+    for ( std::size_t j=0; j<columns.size(); ++j ) {
+      values[j] = static_cast<const char*>(reader.GetColumnData(chunk, j))
+                  + row*columns[j].width;
+    }
+    writer.AddRow(values);
+  };
+
+  if ( ! sort ) {
+    for ( std::size_t i=0; i<shards.size(); ++i ) {
+      for ( uint64_t row=0; row<rows[i].size(); ++row ) addRow(i, row);
+    }
+  }
+  else {
+    // k-way merge of the sorted shards
+    using Entry = std::tuple<int64_t, std::size_t, uint64_t>; // event, shard, row
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> heap;
+    auto eventID = [&shards](std::size_t shard, uint64_t index) {
+      const auto& s = shards[shard];
+      return s.eventIDs[s.order.empty() ? index : s.order[index]];
+    };
+    for ( std::size_t i=0; i<shards.size(); ++i ) {
+      if ( ! rows[i].empty() ) heap.emplace(eventID(i, 0), i, 0);
+    }
+    while ( ! heap.empty() ) {
+      auto [id, shard, row] = heap.top();
+      heap.pop();
+      addRow(shard, row);
+      if ( ++row < rows[shard].size() ) heap.emplace(eventID(shard, row), shard, row);
+    }
+  }
+
+  if ( ! writer.Close() ) {
+    std::cerr << "laueMerge: error writing " << output << std::endl;
+    return 1;
+  }
+  std::cout << "laueMerge: " << writer.GetNofRows() << " rows from "
+            << inputs.size() << " shards written to " << output << std::endl;
+  return 0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+int MergeRoot(const std::string& output, const std::vector<std::string>& inputs,
+              unsigned int nofThreads)
+{
+  std::ostringstream command;
+  command << "hadd -f -j " << nofThreads << " \"" << output << "\"";
+  for ( const auto& input : inputs ) command << " \"" << input << "\"";
+  return std::system(command.str().c_str()) == 0 ? 0 : 1;
+}
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+int main(int argc, char** argv)
+{
+  std::string output;
+  std::vector<std::string> inputs;
+  bool sort = false;
+  unsigned int nofThreads = std::max(1u, std::thread::hardware_concurrency());
+  for ( int i=1; i<argc; ++i ) {
+    std::string arg = argv[i];
+    if      ( arg == "-s" ) sort = true;
+    else if ( arg == "-o" && i+1 < argc ) output = argv[++i];
+    else if ( arg == "-j" && i+1 < argc ) {
+      nofThreads = std::max(1, std::atoi(argv[++i]));
+    }
+    else if ( ! arg.empty() && arg[0] != '-' ) inputs.push_back(arg);
+    else {
+      PrintUsage();
+      return 1;
+    }
+  }
+  if ( output.empty() || inputs.empty() ) {
+    PrintUsage();
+    return 1;
+  }
+
+  if ( HasExtension(output, ".csv") ) {
+    return MergeCsv(output, inputs, sort, nofThreads);
+  }
+  if ( HasExtension(output, ".lcol") ) {
+    return MergeLcol(output, inputs, sort, nofThreads);
+  }
+  if ( HasExtension(output, ".root") ) {
+    if ( sort ) {
+      std::cerr << "laueMerge: sorting is not supported for root files"
+                << std::endl;
+      return 1;
+    }
+    return MergeRoot(output, inputs, nofThreads);
+  }
+
+  std::cerr << "laueMerge: unknown output format " << output << std::endl;
+  return 1;
+}
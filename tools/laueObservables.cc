@@ -0,0 +1,167 @@
+/// \file laueObservables.cc
+/// \brief Key observables of a laueDet run from its columnar output
+///
+/// Reads the lcol files of a run (one row per hit, see ColumnarFormat.hh)
+/// and the detector positions (lookup_table.bin, see LookupTable.hh) and
+/// prints, in JSON:
+///  - the photopeak efficiency: the number of events whose total energy
+///    is within the window around the beam energy, per primary sample
+///    (nof_samples metadata of the files);
+///  - the Compton modulation of the photopeak events with two hits: the
+///    azimuth of each event is the direction from the lower energy hit
+///    (the Compton scattering, below 100 keV at 200 keV) to the other hit
+///    in the xy plane, and the modulation mu and its phase are those of
+///    N(phi) ~ 1 + mu cos(2(phi - phase)), computed from the second
+///    harmonic of the azimuths. The pixels of the detectors also modulate
+///    the azimuths: only a difference between two runs of the same
+///    geometry, or with a non polarised beam, is meaningful.
+
+#include "ColumnarReader.hh"
+#include "LookupTable.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+void PrintUsage()
+{
+  std::cerr << "USAGE" << std::endl;
+  std::cerr << "laueObservables [-e energy] [-w window] [-l lookupTable] "
+            << "events1.lcol [events2.lcol ...]" << std::endl;
+  std::cerr << "  -e  beam energy in keV (default: 200)" << std::endl;
+  std::cerr << "  -w  half width of the photopeak window in keV (default: 2)"
+            << std::endl;
+  std::cerr << "  -l  binary lookup table (default: lookup_table.bin)" << std::endl;
+}
+
+struct Observables
+{
+  double nofSamples = 0.;
+  double nofPhotopeak = 0.;
+  double nofCompton = 0.;
+  double sumCos = 0.;
+  double sumSin = 0.;
+};
+
+// The hits (detector, energy) of one event
+using Hits = std::vector<std::pair<int32_t, double>>;
+
+void AddEvent(const Hits& hits, double energy, double window,
+              const ED::lut::LookupTable& lookupTable, Observables& observables)
+{
+  double total = 0.;
+  for ( const auto& hit : hits ) total += hit.second;
+  if ( std::abs(total - energy) > window ) return;
+  observables.nofPhotopeak += 1.;
+
+  if ( hits.size() != 2 ) return;
+  auto scatter = lookupTable.Find(hits[0].first);
+  auto absorber = lookupTable.Find(hits[1].first);
+  if ( hits[1].second < hits[0].second ) std::swap(scatter, absorber);
+  if ( ! scatter || ! absorber ) return;
+  auto dx = absorber->centre[0] - scatter->centre[0];
+  auto dy = absorber->centre[1] - scatter->centre[1];
+  if ( dx == 0. && dy == 0. ) return;
+
+  auto phi = std::atan2(dy, dx);
+  observables.nofCompton += 1.;
+  observables.sumCos += std::cos(2.*phi);
+  observables.sumSin += std::sin(2.*phi);
+}
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+int main(int argc, char** argv)
+{
+  std::vector<std::string> inputs;
+  double energy = 200.;
+  double window = 2.;
+  std::string lookupTableName = "lookup_table.bin";
+  for ( int i=1; i<argc; ++i ) {
+    std::string arg = argv[i];
+    if      ( arg == "-e" && i+1 < argc ) energy = std::atof(argv[++i]);
+    else if ( arg == "-w" && i+1 < argc ) window = std::atof(argv[++i]);
+    else if ( arg == "-l" && i+1 < argc ) lookupTableName = argv[++i];
+    else if ( ! arg.empty() && arg[0] != '-' ) inputs.push_back(arg);
+    else {
+      PrintUsage();
+      return 1;
+    }
+  }
+  if ( inputs.empty() ) {
+    PrintUsage();
+    return 1;
+  }
+
+  Observables observables;
+  try {
+    auto lookupTable = ED::lut::LookupTable::Read(lookupTableName);
+    for ( const auto& input : inputs ) {
+      ED::lcol::Reader reader(input);
+      const auto& metadata = reader.GetMetadata();
+      for ( auto key : { "nof_samples", "nof_events" } ) {
+        auto samples = metadata.find(key);
+        if ( samples != metadata.end() && std::atof(samples->second.c_str()) > 0. ) {
+          observables.nofSamples += std::atof(samples->second.c_str());
+          break;
+        }
+      }
+
+      // The hits of one event are consecutive rows of one file
+      auto eventColumn = reader.FindColumn("EventID");
+      auto detectorColumn = reader.FindColumn("Detector");
+      auto energyColumn = reader.FindColumn("Energy");
+      Hits hits;
+      int32_t eventID = -1;
+      for ( std::size_t chunk=0; chunk<reader.GetNofChunks(); ++chunk ) {
+        auto eventIDs = reader.GetColumn<int32_t>(chunk, eventColumn);
+        auto detectors = reader.GetColumn<int32_t>(chunk, detectorColumn);
+        auto energies = reader.GetColumn<double>(chunk, energyColumn);
+        for ( std::size_t row=0; row<eventIDs.size(); ++row ) {
+          if ( eventIDs[row] != eventID && ! hits.empty() ) {
+            AddEvent(hits, energy, window, lookupTable, observables);
+            hits.clear();
+          }
+          eventID = eventIDs[row];
+          hits.emplace_back(detectors[row], energies[row]);
+        }
+      }
+      if ( ! hits.empty() ) {
+        AddEvent(hits, energy, window, lookupTable, observables);
+      }
+    }
+  }
+  catch ( const std::exception& e ) {
+    std::cerr << "laueObservables: " << e.what() << std::endl;
+    return 1;
+  }
+
+  const auto& o = observables;
+  auto efficiency = ( o.nofSamples > 0. ) ? o.nofPhotopeak/o.nofSamples : 0.;
+  double modulation = 0.;
+  double modulationError = 0.;
+  double phase = 0.;
+  if ( o.nofCompton > 0. ) {
+    modulation = 2.*std::hypot(o.sumCos, o.sumSin)/o.nofCompton;
+    modulationError
+      = std::sqrt(std::max(0., 2. - modulation*modulation)/o.nofCompton);
+    phase = 0.5*std::atan2(o.sumSin, o.sumCos)*180./M_PI;
+  }
+  std::printf("{\"samples\": %.0f, \"photopeak_events\": %.0f, "
+              "\"photopeak_efficiency\": %.6g, \"compton_events\": %.0f, "
+              "\"modulation\": %.6g, \"modulation_error\": %.6g, "
+              "\"phase_deg\": %.4g}\n",
+              o.nofSamples, o.nofPhotopeak, efficiency, o.nofCompton,
+              modulation, modulationError, phase);
+  return 0;
+}